@@ -2,6 +2,7 @@
 #include "game.h"
 #include "musicmanager.h"
 #include "game/mousecursor.h"
+#include "game/animationlibrary.h"
 #include "i18n.h"
 #include <QFile>
 #include <QDir>
@@ -225,6 +226,7 @@ void Game::loadLevel(const QString &name, const QString& targetZone)
         uniqueCharacterStorage->loadUniqueCharactersToLevel(currentLevel);
         currentLevel->scriptCall("onLoaded");
       }
+      AnimationLibrary::get()->waitForSpriteSheets();
     }
     catch (const std::runtime_error& error)
     {
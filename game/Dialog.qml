@@ -2,6 +2,7 @@ import QtQuick 2.15
 import QtQuick.Controls 2.15
 import "../ui"
 import "../ui/dialog"
+import "level"
 import "qrc:/assets/ui" as UiStyle
 
 Item {
@@ -82,12 +83,37 @@ Item {
   Component {
     id: objectDisplay
     Item {
+      SpriteFrameRegistry {
+        id: npcFrames
+        levelController: gameManager.currentGame.level
+      }
+
       Image {
+        id: npcSprite
+        property rect frameRect
+
+        function refreshFrame() {
+          frameRect = controller.npc.clippedRect;
+        }
+
+        Component.onCompleted: {
+          refreshFrame();
+          npcFrames.register(controller.npc, npcSprite);
+        }
+        Component.onDestruction: npcFrames.unregister(controller.npc, npcSprite)
+
         anchors.centerIn: parent
         source: controller.npc.spriteSource.length > 0 ? "file://" + controller.npc.spriteSource : ""
-        height: controller.npc.clippedRect.height
-        width:  controller.npc.clippedRect.width
-        sourceClipRect: controller.npc.clippedRect
+        height: frameRect.height
+        width:  frameRect.width
+        sourceClipRect: frameRect
+
+        Connections {
+          target: controller.npc
+          function onClippedRectChanged() {
+            npcSprite.refreshFrame();
+          }
+        }
       }
     }
   }
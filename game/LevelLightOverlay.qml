@@ -1,9 +1,12 @@
 import QtQuick 2.15
 import QtGraphicalEffects 1.15
+import "level"
 
 Repeater {
+  id: root
   property QtObject levelController
   property var controller
+  property SpriteFrameRegistry frames: SpriteFrameRegistry { levelController: root.levelController }
 
   model: levelController.dynamicObjects
   delegate: Rectangle {
@@ -12,6 +15,7 @@ Repeater {
     property point    offset: controller.getAdjustedOffsetFor(dynamicObject)
     property var      lightLayer: null
     property color    lightColor: Qt.rgba(1, 1, 1, 0.5)
+    property rect     frameRect
 
     color: "transparent"
     x: offset.x + origin.x
@@ -19,7 +23,16 @@ Repeater {
     visible: lightLayer !== null && lightLayer.visible && dynamicObject.isVisible
 
     onLightLayerChanged: updateVisibility()
-    Component.onCompleted: lightObjectOverlay.updateLightLayer()
+    Component.onCompleted: {
+      lightObjectOverlay.updateLightLayer();
+      lightObjectOverlay.refreshFrame();
+      root.frames.register(dynamicObject, lightObjectOverlay);
+    }
+    Component.onDestruction: root.frames.unregister(dynamicObject, lightObjectOverlay)
+
+    function refreshFrame() {
+      frameRect = dynamicObject.clippedRect;
+    }
 
     function updateLightLayer() {
       for (var i = 0 ; i < levelController.tilemap.lights.length ; ++i) {
@@ -52,6 +65,10 @@ Repeater {
         lightObjectOverlay.offset = controller.getAdjustedOffsetFor(dynamicObject);
       }
 
+      function onAnimationChanged() {
+        lightObjectOverlay.offset = controller.getAdjustedOffsetFor(dynamicObject);
+      }
+
       function onPositionChanged() {
         lightObjectOverlay.updateLightLayer();
       }
@@ -59,6 +76,10 @@ Repeater {
       function onVisibilityChanged() {
         lightObjectOverlay.updateVisibility();
       }
+
+      function onClippedRectChanged() {
+        lightObjectOverlay.refreshFrame();
+      }
     }
 
     Timer {
@@ -72,7 +93,7 @@ Repeater {
       id: lightObjectBase
       visible: false
       source: "file:" + dynamicObject.spriteSource
-      sourceClipRect: dynamicObject.clippedRect
+      sourceClipRect: lightObjectOverlay.frameRect
     }
 
     Rectangle {
@@ -4,7 +4,7 @@
 MovementHintAnimationPart::MovementHintAnimationPart(QPoint position)
 {
   TileLayer* layer;
-  Tile*      tile;
+  Tile       tile;
 
   sprite = new Sprite();
   level  = Game::get()->getLevel();
@@ -14,6 +14,6 @@ MovementHintAnimationPart::MovementHintAnimationPart(QPoint position)
   sprite->setSpriteName("misc");
   sprite->setAnimation("movement-hint");
   if (tile)
-    from = to = tile->getRenderPosition();
+    from = to = tile.getRenderPosition();
   QObject::connect(sprite, &Sprite::animationFinished, std::bind(&SpriteAnimationPart::onAnimationFinished, this));
 }
@@ -4,7 +4,10 @@
 #include <QRegularExpression>
 #include <QFile>
 #include <QJsonDocument>
+#include <QMutexLocker>
+#include <QCryptographicHash>
 #include <QDebug>
+#include <algorithm>
 
 QmlSpriteAnimation::QmlSpriteAnimation(QObject* parent) : QObject(parent)
 {
@@ -103,10 +106,14 @@ AnimationLibrary* AnimationLibrary::self = nullptr;
 AnimationLibrary::AnimationLibrary(QObject *parent) : QObject(parent)
 {
   self = this;
+  unusedImages.setMaxCost(unusedImagesBudget);
 }
 
+// Pending sheets are dropped, and running ones finished, before the members they use go away
 AnimationLibrary::~AnimationLibrary()
 {
+  spriteSheetPool.clear();
+  spriteSheetPool.waitForDone();
   self = nullptr;
 }
 
@@ -134,29 +141,84 @@ void AnimationLibrary::initialize()
           textures << source;
       }
     }
-    for (const auto& texture : textures)
-      images.insert(ASSETS_PATH + "sprites/" + texture, QImage(ASSETS_PATH + "sprites/" + texture));
+    loadSpriteSheetManifest();
+    for (const QString& groupName : data.keys())
+      compileGroup(groupName);
     emit initialized();
   }
   else
     qDebug() << "!! Could not load sprites.json";
 }
 
-const QImage& AnimationLibrary::getImage(const QString& group, const QString& animation) const
+QImage AnimationLibrary::getImage(const QString& group, const QString& animation) const
 {
   return getImage(getAnimation(group, animation).source);
 }
 
-const QImage& AnimationLibrary::getImage(const QString& source) const
+static int imageCost(const QImage& image)
+{
+  return static_cast<int>(image.sizeInBytes() / 1024) + 1;
+}
+
+static QImage decodeImage(const QString& source)
 {
-  const auto iterator = images.constFind(source);
+  QImage image(source);
 
-  if (iterator == images.end())
+  if (image.isNull())
   {
-    qDebug() << "Could not find Image for picture" << source << "in" << images.keys();
+    qDebug() << "Could not find Image for picture" << source;
     throw std::out_of_range("no source for animation");
   }
-  return *iterator;
+  return image;
+}
+
+// Images are decoded on first use. Those referenced by sprites stay loaded, the
+// others are kept in a LRU cache until unusedImagesBudget is exceeded. They are
+// returned by value, as the cache may evict them while the caller uses them.
+QImage AnimationLibrary::getImage(const QString& source) const
+{
+  auto used = usedImages.find(source);
+
+  if (used != usedImages.end())
+  {
+    if (used->isNull())
+      *used = decodeImage(source);
+    return *used;
+  }
+
+  QImage* cached = unusedImages.object(source);
+
+  if (!cached)
+  {
+    cached = new QImage(decodeImage(source));
+    unusedImages.insert(source, cached, std::min(imageCost(*cached), unusedImages.maxCost()));
+  }
+  return *cached;
+}
+
+void AnimationLibrary::retainImage(const QString& source)
+{
+  if (!source.isEmpty() && imageReferences[source]++ == 0)
+  {
+    QImage* cached = unusedImages.take(source);
+
+    usedImages.insert(source, cached ? *cached : QImage());
+    delete cached;
+  }
+}
+
+void AnimationLibrary::releaseImage(const QString& source)
+{
+  auto it = imageReferences.find(source);
+
+  if (it != imageReferences.end() && --(*it) <= 0)
+  {
+    QImage image = usedImages.take(source);
+
+    imageReferences.erase(it);
+    if (!image.isNull())
+      unusedImages.insert(source, new QImage(image), std::min(imageCost(image), unusedImages.maxCost()));
+  }
 }
 
 static SpriteAnimation makeDefaultSpriteAnimation(const QString& animation, const QString& defaultSource)
@@ -171,9 +233,21 @@ static SpriteAnimation makeDefaultSpriteAnimation(const QString& animation, cons
   object.frameInterval = 0;
   object.firstFramePosition = QPoint(0, 0);
   object.clippedRect = QRect(0, 0, 0, 0);
+  object.frames << object.clippedRect;
   return object;
 }
 
+// Frames follow each other horizontally, going left when the animation is reversed
+static void bakeFrames(SpriteAnimation& animation)
+{
+  int step = animation.reverse ? -animation.clippedRect.width() : animation.clippedRect.width();
+
+  animation.frames.clear();
+  animation.frames.reserve(std::max(1, animation.frameCount));
+  for (int i = 0 ; i < std::max(1, animation.frameCount) ; ++i)
+    animation.frames << QRect(animation.firstFramePosition + QPoint(step * i, 0), animation.clippedRect.size());
+}
+
 static QPoint getFirstFramePosition(SpriteAnimation& sprite, const QJsonObject& data)
 {
   QPoint point(data["offsetX"].toInt(0), data["offsetY"].toInt(0));
@@ -183,59 +257,121 @@ static QPoint getFirstFramePosition(SpriteAnimation& sprite, const QJsonObject&
   return point;
 }
 
-SpriteAnimation AnimationLibrary::getAnimation(const QString &group, const QString &animation) const
+static SpriteAnimation makeSpriteAnimation(const QString& animation, const QJsonObject& animationData, const QString& defaultSource)
 {
   SpriteAnimation object;
-  auto groupData = data[group];
-  auto animationData = groupData[animation];
-  auto defaultSource = groupData["defaultSource"].toString();
+  QString relativeSource = animationData["source"].toString();
+
+  object.name          = animation;
+  object.source        = ASSETS_PATH + "sprites/";
+  object.source       += relativeSource.length() > 0 ? relativeSource : defaultSource;
+  object.repeat        = animationData["repeat"].toBool(false);
+  object.frameCount    = animationData["frameCount"].toInt(1);
+  object.frameInterval = animationData["frameInterval"].toInt(100);
+  object.reverse       = animationData["reverse"].toBool();
+  object.firstFramePosition = getFirstFramePosition(object, animationData);
+  object.clippedRect.setX(object.firstFramePosition.x());
+  object.clippedRect.setY(object.firstFramePosition.y());
+  object.clippedRect.setWidth(animationData["width"].toInt());
+  object.clippedRect.setHeight(animationData["height"].toInt());
+  return object;
+}
 
+void AnimationLibrary::compileGroup(const QString& groupName)
+{
+  auto        idIt = groupIds.constFind(groupName);
+  int         groupId;
+  QJsonObject groupData = data[groupName].toObject();
+  QString     defaultSource = groupData["defaultSource"].toString();
+
+  if (idIt == groupIds.constEnd())
+  {
+    groupId = groups.size();
+    groupIds.insert(groupName, groupId);
+    groups.push_back(AnimationGroup());
+  }
+  else
+    groupId = *idIt;
   if (!groupData["cloneOf"].isUndefined())
+    groupData = data[groupData["cloneOf"].toString()].toObject();
+
+  AnimationGroup& group = groups[groupId];
+
+  group = AnimationGroup();
+  for (auto it = groupData.constBegin() ; it != groupData.constEnd() ; ++it)
   {
-    defaultSource = groupData["defaultSource"].toString();
-    groupData     = data[groupData["cloneOf"].toString()].toObject();
-    animationData = groupData[animation];
+    if (it.value().isObject())
+    {
+      SpriteAnimation animation = makeSpriteAnimation(it.key(), it.value().toObject(), defaultSource);
+
+      bakeFrames(animation);
+      group.animationIds.insert(it.key(), group.animations.size());
+      group.animations << animation;
+    }
   }
-  if (animationData.isObject())
+  group.fallback = group.animationIds.value("idle", group.animationIds.value("idle-down", -1));
+  group.defaultAnimation = makeDefaultSpriteAnimation(QString(), defaultSource);
+}
+
+// Recompiles a group edited from the editor, along with the groups cloning it
+void AnimationLibrary::rebuildGroup(const QString& groupName)
+{
+  compileGroup(groupName);
+  for (auto it = data.constBegin() ; it != data.constEnd() ; ++it)
   {
-    QString relativeSource = animationData["source"].toString();
-
-    object.name          = animation;
-    object.source        = ASSETS_PATH + "sprites/";
-    object.source       += relativeSource.length() > 0 ? relativeSource : defaultSource;
-    object.repeat        = animationData["repeat"].toBool(false);
-    object.frameCount    = animationData["frameCount"].toInt(1);
-    object.frameInterval = animationData["frameInterval"].toInt(100);
-    object.reverse       = animationData["reverse"].toBool();
-    object.firstFramePosition = getFirstFramePosition(object, animationData.toObject());
-    object.clippedRect.setX(object.firstFramePosition.x());
-    object.clippedRect.setY(object.firstFramePosition.y());
-    object.clippedRect.setWidth(animationData["width"].toInt());
-    object.clippedRect.setHeight(animationData["height"].toInt());
+    if (it.value()["cloneOf"].toString() == groupName)
+      compileGroup(it.key());
   }
-  else if (groupData["idle"].isObject())
-    return getAnimation(group, "idle");
-  else if (groupData["idle-down"].isObject())
-    return getAnimation(group, "idle-down");
-  else
-    return makeDefaultSpriteAnimation(animation, defaultSource);
-  return object;
 }
 
-bool AnimationLibrary::hasAnimation(const QString& group, const QString& animation) const
+int AnimationLibrary::getGroupId(const QString& group) const
 {
-  SpriteAnimation object;
-  auto groupData = data[group];
-  auto animationData = groupData[animation];
-  auto defaultSource = groupData["defaultSource"].toString();
+  return groupIds.value(group, -1);
+}
 
-  if (!groupData["cloneOf"].isUndefined())
+int AnimationLibrary::getAnimationId(int groupId, const QString& animation) const
+{
+  if (groupId >= 0 && groupId < groups.size())
   {
-    defaultSource = groupData["defaultSource"].toString();
-    groupData     = data[groupData["cloneOf"].toString()].toObject();
-    animationData = groupData[animation];
+    const AnimationGroup& group = groups.at(groupId);
+
+    return group.animationIds.value(animation, group.fallback);
+  }
+  return -1;
+}
+
+// An animationId of -1 yields the group's default animation, which has no name
+const SpriteAnimation& AnimationLibrary::getAnimation(int groupId, int animationId) const
+{
+  static const SpriteAnimation noAnimation = makeDefaultSpriteAnimation(QString(), QString());
+
+  if (groupId >= 0 && groupId < groups.size())
+  {
+    const AnimationGroup& group = groups.at(groupId);
+
+    if (animationId >= 0 && animationId < group.animations.size())
+      return group.animations.at(animationId);
+    return group.defaultAnimation;
   }
-  return animationData.isObject();
+  return noAnimation;
+}
+
+SpriteAnimation AnimationLibrary::getAnimation(const QString &group, const QString &animation) const
+{
+  int             groupId     = getGroupId(group);
+  int             animationId = getAnimationId(groupId, animation);
+  SpriteAnimation object      = getAnimation(groupId, animationId);
+
+  if (animationId < 0)
+    object.name = animation;
+  return object;
+}
+
+bool AnimationLibrary::hasAnimation(const QString& group, const QString& animation) const
+{
+  int groupId = getGroupId(group);
+
+  return groupId >= 0 && groups.at(groupId).animationIds.contains(animation);
 }
 
 QString AnimationLibrary::getDefaultSource(const QString& group) const
@@ -251,6 +387,7 @@ void AnimationLibrary::setDefaultSource(const QString& group, const QString& def
 
   groupData.insert("defaultSource", defaultSource);
   data[group] = groupData;
+  rebuildGroup(group);
 }
 
 void AnimationLibrary::setAnimation(const QString& group, const QString& name, QmlSpriteAnimation* animation)
@@ -297,6 +434,7 @@ void AnimationLibrary::setAnimationWithDefaultSource(const QString &group, const
       groupData.insert(animation->name, animationData);
       groupData.remove("cloneOf");
       data[group] = groupData;
+      rebuildGroup(group);
     }
     else
       setAnimationWithDefaultSource(groupData["cloneOf"].toString(), name, animation, defaultSource);
@@ -326,6 +464,7 @@ void AnimationLibrary::remove(const QString &group, const QString &name)
     data[group] = groupData;
   else
     data.remove(group);
+  rebuildGroup(group);
   save();
 }
 
@@ -383,12 +522,48 @@ QString AnimationLibrary::getCharacterSpriteFilepath(const CharacterSpriteDescri
   return prerenderPath + '/' + getCharacterSpriteName(descriptor) + '.' + getCharacterSpriteFormat();
 }
 
+QString AnimationLibrary::getCharacterSpriteHash(const CharacterSpriteDescriptor& descriptor) const
+{
+  return QCryptographicHash::hash(getCharacterSpriteName(descriptor).toUtf8(), QCryptographicHash::Sha1).toHex();
+}
+
 bool AnimationLibrary::hasSpriteSheetBeenPreRendered(const CharacterSpriteDescriptor& descriptor) const
 {
-  return QFile::exists(getCharacterSpriteFilepath(descriptor));
+  return spriteSheetManifest.contains(getCharacterSpriteHash(descriptor));
+}
+
+// The manifest lists the sprite sheets already rendered, keyed by descriptor hash.
+// Entries whose file went missing are dropped once, at startup.
+void AnimationLibrary::loadSpriteSheetManifest()
+{
+  QFile manifestFile(prerenderPath + "/manifest.json");
+
+  if (manifestFile.open(QIODevice::ReadOnly))
+  {
+    QJsonObject manifest = QJsonDocument::fromJson(manifestFile.readAll()).object();
+
+    for (auto it = manifest.constBegin() ; it != manifest.constEnd() ; ++it)
+    {
+      if (QFile::exists(it.value().toString()))
+        spriteSheetManifest.insert(it.key(), it.value().toString());
+    }
+  }
+}
+
+void AnimationLibrary::saveSpriteSheetManifest() const
+{
+  QFile       manifestFile(prerenderPath + "/manifest.json");
+  QJsonObject manifest;
+
+  for (auto it = spriteSheetManifest.constBegin() ; it != spriteSheetManifest.constEnd() ; ++it)
+    manifest.insert(it.key(), it.value());
+  if (manifestFile.open(QIODevice::WriteOnly))
+    manifestFile.write(QJsonDocument(manifest).toJson());
+  else
+    qDebug() << "AnimationLibrary: cannot write" << manifestFile.fileName();
 }
 
-void AnimationLibrary::prerenderCharacterSpriteSheet(const CharacterSpriteDescriptor& descriptor)
+void AnimationLibrary::prerenderCharacterSpriteSheet(const CharacterSpriteDescriptor& descriptor) const
 {
   const QImage       baseImage(ASSETS_PATH + "sprites/characters/" + descriptor.base + ".png");
   const QString      shadowPath(ASSETS_PATH + "sprites/characters/" + descriptor.base + "-shadow.png");
@@ -428,21 +603,78 @@ void AnimationLibrary::prerenderCharacterSpriteSheet(const CharacterSpriteDescri
   spritesheet.save(getCharacterSpriteFilepath(descriptor));
 }
 
+// Sprite sheets that haven't been rendered yet are queued on spriteSheetPool. Meanwhile,
+// the group uses the default source of the group it clones as a placeholder.
 void AnimationLibrary::registerCharacterSpriteSheet(const CharacterSpriteDescriptor& descriptor)
 {
   QString name = getCharacterSpriteName(descriptor);
 
   if (!data[name].isObject())
   {
-    QString filePath = getCharacterSpriteFilepath(descriptor);
     QJsonObject spriteData;
 
-    if (!hasSpriteSheetBeenPreRendered(descriptor))
-      prerenderCharacterSpriteSheet(descriptor);
-    spriteData["defaultSource"] = "../../" + getCharacterSpriteFilepath(descriptor);
-    spriteData["cloneOf"]       = descriptor.cloneOf;
+    if (hasSpriteSheetBeenPreRendered(descriptor))
+      spriteData["defaultSource"] = "../../" + getCharacterSpriteFilepath(descriptor);
+    else
+    {
+      spriteData["defaultSource"] = getDefaultSource(descriptor.cloneOf);
+      generatingSpriteSheets.insert(name);
+      spriteSheetPool.start([this, descriptor]()
+      {
+        prerenderCharacterSpriteSheet(descriptor);
+        {
+          QMutexLocker lock(&renderedSpriteSheetsMutex);
+          renderedSpriteSheets << descriptor;
+        }
+        QMetaObject::invokeMethod(this, [this]() { applyRenderedSpriteSheets(); }, Qt::QueuedConnection);
+      });
+    }
+    spriteData["cloneOf"] = descriptor.cloneOf;
     data[name] = spriteData;
+    compileGroup(name);
+    if (!textures.contains(spriteData["defaultSource"].toString()))
+      textures << spriteData["defaultSource"].toString();
+  }
+}
+
+// Workers only queue their results: they are applied on the main thread, either
+// by the event loop or by waitForSpriteSheets, whichever comes first.
+void AnimationLibrary::applyRenderedSpriteSheets()
+{
+  QVector<CharacterSpriteDescriptor> descriptors;
+
+  {
+    QMutexLocker lock(&renderedSpriteSheetsMutex);
+    descriptors.swap(renderedSpriteSheets);
+  }
+  for (const CharacterSpriteDescriptor& descriptor : qAsConst(descriptors))
+    onSpriteSheetRendered(descriptor);
+}
+
+void AnimationLibrary::onSpriteSheetRendered(const CharacterSpriteDescriptor& descriptor)
+{
+  QString     name = getCharacterSpriteName(descriptor);
+  QString     filePath = getCharacterSpriteFilepath(descriptor);
+  QJsonObject spriteData = data[name].toObject();
+
+  spriteSheetManifest.insert(getCharacterSpriteHash(descriptor), filePath);
+  saveSpriteSheetManifest();
+  spriteData["defaultSource"] = "../../" + filePath;
+  data[name] = spriteData;
+  if (!textures.contains(spriteData["defaultSource"].toString()))
     textures << spriteData["defaultSource"].toString();
-    images.insert(ASSETS_PATH + "sprites/" + spriteData["defaultSource"].toString(), QImage(filePath));
+  compileGroup(name);
+  generatingSpriteSheets.remove(name);
+  emit spriteSheetReady(name);
+}
+
+// Holds level loading until the sprite sheets it needs are rendered. Events aren't
+// processed meanwhile, as they could run against the half-loaded level.
+void AnimationLibrary::waitForSpriteSheets()
+{
+  if (!generatingSpriteSheets.isEmpty())
+  {
+    spriteSheetPool.waitForDone();
+    applyRenderedSpriteSheets();
   }
 }
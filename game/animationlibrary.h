@@ -5,6 +5,12 @@
 # include <QJsonObject>
 # include <QRect>
 # include <QMap>
+# include <QHash>
+# include <QVector>
+# include <QCache>
+# include <QSet>
+# include <QThreadPool>
+# include <QMutex>
 # include <QImage>
 
 struct CharacterSpriteDescriptor
@@ -26,6 +32,7 @@ struct SpriteAnimation
   bool    repeat;
   int     currentFrame = 0;
   bool    reverse = false;
+  QVector<QRect> frames;
 };
 
 class QmlSpriteAnimation : public QObject, public SpriteAnimation
@@ -76,12 +83,19 @@ public:
   explicit AnimationLibrary(QObject *parent = nullptr);
   virtual ~AnimationLibrary() override;
 
+  static const int unusedImagesBudget = 64 * 1024; // in kilobytes
+
   static AnimationLibrary* get() { return self; }
   void initialize();
   SpriteAnimation getAnimation(const QString& group, const QString& animation) const;
   bool            hasAnimation(const QString& group, const QString& name) const;
-  const QImage& getImage(const QString& group, const QString& animation) const;
-  const QImage& getImage(const QString& source) const;
+  int                    getGroupId(const QString& group) const;
+  int                    getAnimationId(int groupId, const QString& animation) const;
+  const SpriteAnimation& getAnimation(int groupId, int animationId) const;
+  QImage                 getImage(const QString& group, const QString& animation) const;
+  QImage                 getImage(const QString& source) const;
+  void retainImage(const QString& source);
+  void releaseImage(const QString& source);
 
   Q_INVOKABLE QStringList getSources() const { return textures; }
   Q_INVOKABLE QStringList getGroups() const;
@@ -101,16 +115,44 @@ public:
   QString getCharacterSpriteFilepath(const CharacterSpriteDescriptor&) const;
   bool hasSpriteSheetBeenPreRendered(const CharacterSpriteDescriptor&) const;
   void registerCharacterSpriteSheet(const CharacterSpriteDescriptor&);
-  void prerenderCharacterSpriteSheet(const CharacterSpriteDescriptor&);
+  void prerenderCharacterSpriteSheet(const CharacterSpriteDescriptor&) const;
+  void waitForSpriteSheets();
 
 signals:
   void initialized();
+  void spriteSheetReady(const QString& group);
 
 private:
-  QStringList           textures;
-  QMap<QString, QImage> images;
-  QJsonObject           data;
-  static const QString  prerenderPath;
+  // sprites.json compiled for lookups: clones and sources are already resolved
+  struct AnimationGroup
+  {
+    QVector<SpriteAnimation> animations;
+    QHash<QString, int>      animationIds;
+    SpriteAnimation          defaultAnimation;
+    int                      fallback = -1;
+  };
+
+  void compileGroup(const QString& group);
+  void rebuildGroup(const QString& group);
+  void loadSpriteSheetManifest();
+  void saveSpriteSheetManifest() const;
+  void onSpriteSheetRendered(const CharacterSpriteDescriptor&);
+  void applyRenderedSpriteSheets();
+  QString getCharacterSpriteHash(const CharacterSpriteDescriptor&) const;
+
+  QStringList                     textures;
+  mutable QMap<QString, QImage>   usedImages;
+  QHash<QString, int>             imageReferences;
+  mutable QCache<QString, QImage> unusedImages;
+  QJsonObject                     data;
+  QHash<QString, QString>         spriteSheetManifest;
+  QSet<QString>                   generatingSpriteSheets;
+  QThreadPool                     spriteSheetPool;
+  QMutex                          renderedSpriteSheetsMutex;
+  QVector<CharacterSpriteDescriptor> renderedSpriteSheets;
+  QVector<AnimationGroup> groups;
+  QHash<QString, int>     groupIds;
+  static const QString    prerenderPath;
 };
 
 #endif // ANIMATIONLIBRARY_H
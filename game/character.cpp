@@ -20,9 +20,9 @@ Character::Character(QObject *parent) : ParentType(parent)
   connect(this, &Sprite::animationFinished, this, &Character::afterDeathAnimation);
 }
 
-void Character::update(qint64 delta)
+void Character::applyUpdate()
 {
-  ParentType::update(delta);
+  ParentType::applyUpdate();
   if (isAlive())
   {
     auto* level = Game::get()->getLevel();
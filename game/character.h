@@ -22,7 +22,7 @@ class Character : public CharacterBuffs
 public:
   explicit Character(QObject *parent = nullptr);
 
-  void update(qint64) override;
+  void applyUpdate() override;
   void load(const QJsonObject&) override;
   void save(QJsonObject&) const override;
 
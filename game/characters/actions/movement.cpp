@@ -5,8 +5,11 @@ bool MovementAction::trigger()
 {
   ZoneGrid& grid = Game::get()->getLevel()->getPathfinder();
 
+  cancelPathRequest();
   if (character->getPoint() == target)
     state = Done;
+  else if (canDeferPathfinding())
+    requestPath({target});
   else if (grid.findPath(character->getPoint(), target, character->rcurrentPath(), character))
     state = InProgress;
   else
@@ -15,8 +18,55 @@ bool MovementAction::trigger()
   return state == InProgress;
 }
 
+// Outside of combat, NPCs don't need their path right away: their requests are
+// queued on the ZoneGrid and resolved together at the end of the level tick.
+bool MovementAction::canDeferPathfinding() const
+{
+  auto* level = Game::get()->getLevel();
+
+  return character != level->getPlayer() && !level->isInCombat(character);
+}
+
+void MovementAction::requestPath(const QVector<Point>& candidates)
+{
+  ZoneGrid& grid = Game::get()->getLevel()->getPathfinder();
+
+  pathRequest = grid.requestPath(character->getPoint(), candidates, character);
+  state = InProgress;
+}
+
+void MovementAction::cancelPathRequest()
+{
+  if (pathRequest)
+  {
+    pathRequest->cancelled = true;
+    pathRequest.reset();
+  }
+}
+
+bool MovementAction::receivePath()
+{
+  if (pathRequest->resolved)
+  {
+    bool found = pathRequest->found;
+
+    character->rcurrentPath() = pathRequest->path;
+    pathRequest.reset();
+    onPathReceived(found);
+    return state == InProgress;
+  }
+  return false;
+}
+
+void MovementAction::onPathReceived(bool found)
+{
+  state = found ? InProgress : Interrupted;
+}
+
 void MovementAction::update()
 {
+  if (isAwaitingPath() && !receivePath())
+    return ;
   if (!character->isSpriteMoving())
   {
     if (firstRound)
@@ -76,14 +126,14 @@ void MovementAction::triggerNextMovement()
     auto*  grid         = level->getFloorGrid(character->getCurrentFloor());
     auto*  currentCase  = grid->getGridCase(character->getPoint());
     auto*  nextCase     = grid->getGridCase(nextPosition);
-    auto*  connection   = currentCase ? currentCase->connectionWith(nextCase) : nullptr;
+    auto   connection   = currentCase ? currentCase->connectionWith(nextCase) : LevelGrid::CaseConnection();
     int    ap           = 1;
 
-    if (connection && nextCase && (!nextCase->occupied || nextCase->occupant == character))
+    if (connection.isValid() && nextCase && (!nextCase->occupied || nextCase->occupant == character))
     {
       if (currentCase->position.z != nextPosition.z)
         ap = 3;
-      if (connection->goThrough(character) && character->useActionPoints(ap, "movement"))
+      if (connection.goThrough(character) && character->useActionPoints(ap, "movement"))
         character->moveTo(nextPosition);
       else
         state = Interrupted;
@@ -103,6 +153,7 @@ void MovementAction::triggerNextMovement()
 
 void MovementAction::interrupt()
 {
+  cancelPathRequest();
   character->onIdle();
   onMovementFinished();
 }
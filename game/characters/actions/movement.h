@@ -2,6 +2,7 @@
 # define MOVEMENT_ACTION_H
 
 # include "base.h"
+# include "game/pathfinding/pathrequest.h"
 # include <QPoint>
 
 class MovementAction : public ActionBase
@@ -11,6 +12,8 @@ public:
   {
   }
 
+  ~MovementAction() override { cancelPathRequest(); }
+
   int  getApCost() const override;
   virtual bool trigger() override;
   void update() override;
@@ -21,10 +24,18 @@ protected:
   virtual void onMovementFinished();
   int pathApCost(const QList<Point>&) const;
   bool canMakeNextMovement() const;
+  bool canDeferPathfinding() const;
+  void requestPath(const QVector<Point>& candidates);
+  void cancelPathRequest();
+  bool isAwaitingPath() const { return pathRequest != nullptr; }
+  virtual void onPathReceived(bool found);
 
   Point target;
 private:
+  bool receivePath();
+
   bool firstRound = true;
+  PathRequestPtr pathRequest;
 };
 
 #endif
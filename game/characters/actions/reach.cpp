@@ -111,13 +111,21 @@ bool ReachAction::trigger()
     int caseDistance = static_cast<int>(std::floor(range));
     auto candidates = getCandidates(caseDistance);
 
+    cancelPathRequest();
     state = Interrupted;
-    if (grid.findPath(character->getPoint(), candidates, character->rcurrentPath(), character))
+    if (candidates.size() > 0 && canDeferPathfinding())
+      requestPath(candidates);
+    else if (grid.findPath(character->getPoint(), candidates, character->rcurrentPath(), character))
       state = canMakeNextMovement() ? InProgress : Interrupted;
   }
   return state == Done || state == InProgress;
 }
 
+void ReachAction::onPathReceived(bool found)
+{
+  state = found && canMakeNextMovement() ? InProgress : Interrupted;
+}
+
 void ReachAction::triggerNextMovement()
 {
   MovementAction::triggerNextMovement();
@@ -20,6 +20,7 @@ public:
 
 protected:
   void triggerNextMovement() override;
+  void onPathReceived(bool found) override;
   QVector<Point> getCandidates(int caseDistance) const;
   virtual bool alreadyReached() const;
   virtual Point getTargetPosition() const { return object->getPoint(); }
@@ -222,18 +222,33 @@ bool FieldOfView::IsCharacterInList(const Character* character_to_check, const s
 
 void FieldOfView::detectCharacters()
 {
-  CharacterList characters_in_range = GetCharactersInRange();
-  auto          iterator            = characters_in_range.begin();
+  CharacterList   characters_in_range = GetCharactersInRange();
+  CharacterList   sight_targets;
+  QVector<QPoint> sight_positions;
+  Point           origin = character.getPoint();
 
-  for (; iterator < characters_in_range.end() ; ++iterator)
+  for (Character* checking_character : characters_in_range)
   {
-    Character* checking_character = *iterator;
-
     if (checking_character != &character)
     {
       if (character.isAlly(checking_character) || !checking_character->isAlive())
         setCharacterDetected(checking_character);
-      else if (character.hasLineOfSight(checking_character) && CheckIfEnemyIsDetected(*checking_character))
+      else if (checking_character->getPoint().z == origin.z)
+      {
+        sight_targets << checking_character;
+        sight_positions << checking_character->getPosition();
+      }
+    }
+  }
+  if (sight_targets.size() > 0)
+  {
+    QVector<int> qualities = Game::get()->getLevel()->getVisibility().getVisionQualities(origin, sight_positions);
+
+    for (int i = 0 ; i < sight_targets.size() ; ++i)
+    {
+      Character* checking_character = sight_targets[i];
+
+      if (qualities[i] > 0 && CheckIfEnemyIsDetected(*checking_character))
       {
         if (character.isEnemy(checking_character) && checking_character->isAlive())
           setEnemyDetected(checking_character);
@@ -290,13 +305,7 @@ float FieldOfView::GetRadius() const
 
 FieldOfView::CharacterList FieldOfView::GetCharactersInRange() const
 {
-  float field_of_view_radius = GetRadius();
-  auto* level = Game::get()->getLevel();
-
-  return level->findCharacters([this, field_of_view_radius](Character& other) -> bool
-  {
-    return (&other != &character && other.getDistance(&character) < field_of_view_radius);
-  });
+  return Game::get()->getLevel()->getVisibility().getCharactersInRange(character, GetRadius());
 }
 
 void FieldOfView::LoseTrackOfCharacters(std::list<Entry>& entries)
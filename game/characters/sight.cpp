@@ -37,12 +37,7 @@ bool CharacterSight::hasSightFrom(Point target, Point pos)
   auto* level = Game::get()->getLevel();
 
   if (target.z == pos.z && level)
-  {
-    auto*  grid   = level->getFloorGrid(target.z);
-    int    score  = grid->getVisionQuality(pos.x, pos.y, target.x, target.y);
-
-    return score > 0;
-  }
+    return level->getVisibility().hasLineOfSight(pos, target);
   return false;
 }
 
@@ -35,7 +35,8 @@ public:
   explicit DynamicObject(QObject *parent = nullptr);
   virtual ~DynamicObject();
 
-  virtual void update(qint64 v) { ParentType::update(v); }
+  virtual void update(qint64 v) { computeUpdate(v); applyUpdate(); }
+  virtual void applyUpdate() { ParentType::applyUpdate(); }
   virtual void updateTasks(qint64 v);
   virtual void load(const QJsonObject&);
   virtual void save(QJsonObject&) const;
@@ -1,5 +1,6 @@
 import QtQuick 2.15
 import QtGraphicalEffects 1.15
+import "../level"
 
 Repeater {
   id: root
@@ -10,18 +11,28 @@ Repeater {
   property color    overlayMaxColor: Qt.rgba(255, 255, 0, 0.5)
   property int      offsetX
   property int      offsetY
+  property SpriteFrameRegistry frames: SpriteFrameRegistry { levelController: root.levelController }
 
   delegate: Image {
     id: dynamicObjectLayer
     property QtObject dynamicObject: root.model[index]
     property point offset: levelController.getAdjustedOffsetFor(dynamicObject)
+    property rect frameRect
 
     function updateVisibility() {
       dynamicObjectLayer.visible = root.filter(dynamicObject);
     }
 
-    Component.onCompleted: updateVisibility()
-    onSourceClipRectChanged: offset = levelController.getAdjustedOffsetFor(dynamicObject)
+    function refreshFrame() {
+      frameRect = dynamicObject.clippedRect;
+    }
+
+    Component.onCompleted: {
+      updateVisibility();
+      refreshFrame();
+      root.frames.register(dynamicObject, dynamicObjectLayer);
+    }
+    Component.onDestruction: root.frames.unregister(dynamicObject, dynamicObjectLayer)
 
     Timer {
       running: root.visible
@@ -46,7 +57,7 @@ Repeater {
 
     enabled: visible
     source: "file:" + dynamicObject.spriteSource
-    sourceClipRect: dynamicObject.clippedRect
+    sourceClipRect: frameRect
     x: offset.x + root.offsetX
     y: offset.y + root.offsetY
 
@@ -55,6 +66,12 @@ Repeater {
       function onSpritePositionChanged() {
         dynamicObjectLayer.offset = levelController.getAdjustedOffsetFor(dynamicObject);
       }
+      function onAnimationChanged() {
+        dynamicObjectLayer.offset = levelController.getAdjustedOffsetFor(dynamicObject);
+      }
+      function onClippedRectChanged() {
+        dynamicObjectLayer.refreshFrame();
+      }
     }
   }
 }
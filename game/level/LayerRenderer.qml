@@ -1,4 +1,5 @@
 import QtQuick 2.15
+import Tiles 1.0
 
 Item {
   id: root
@@ -34,22 +35,8 @@ Item {
 
   Component {
     id: dynamicRenderer
-    Repeater {
-      model: tileLayer.tiles.length
-      delegate: Loader {
-        property QtObject tile: tileLayer.tiles[index]
-        sourceComponent: tile ? tileRenderer : null
-
-        Component {
-          id: tileRenderer
-          Image {
-            source: fileProtocol + tile.image
-            sourceClipRect: tile.clippedRect
-            x: tile.renderPosition.x
-            y: tile.renderPosition.y
-          }
-        }
-      }
+    TileLayerItem {
+      tileLayer: root.tileLayer
     }
   }
 }
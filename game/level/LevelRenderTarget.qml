@@ -1,5 +1,6 @@
 import QtQuick 2.15
 import QtQuick.Controls 2.15
+import Game 1.0
 
 Rectangle {
   property QtObject levelController: parent.levelController
@@ -34,18 +35,39 @@ Rectangle {
   Item {
     x: parent.width / 2
 
-    Image {
+    Item {
       id: groundLayer
-      source: `file:///${levelController.preRenderPath}floor${levelController.currentFloor}_tilemap.png`
       x:      groundRect.x
       y:      groundRect.y
       width:  groundRect.width
       height: groundRect.height
 
-      DaylightShader {
-        source:  groundLayer
-        color:   renderTarget.levelController.ambientColor
-        enabled: renderTarget.levelController.useAmbientLight
+      Repeater {
+        model: PreRenderChunkModel {
+          indexFile: `${levelController.preRenderPath}floor${levelController.currentFloor}_tilemap.json`
+          viewport: Qt.rect(
+            -renderTarget.x - renderTarget.width / 2 - groundLayer.x,
+            -renderTarget.y - groundLayer.y,
+            renderTarget.parent.width,
+            renderTarget.parent.height
+          )
+        }
+        delegate: Image {
+          id: groundChunk
+          source: model.source
+          cache: false
+          asynchronous: true
+          x:      model.chunkRect.x
+          y:      model.chunkRect.y
+          width:  model.chunkRect.width
+          height: model.chunkRect.height
+
+          DaylightShader {
+            source:  groundChunk
+            color:   renderTarget.levelController.ambientColor
+            enabled: renderTarget.levelController.useAmbientLight
+          }
+        }
       }
     }
 
@@ -81,13 +103,35 @@ Rectangle {
     }
 
     Repeater {
+      id: visualEffectsRenderer
+      property SpriteFrameRegistry frames: SpriteFrameRegistry { levelController: renderTarget.levelController }
       model: renderTarget.levelController.visualEffects
       delegate: Image {
+        id: visualEffectRenderer
         readonly property QtObject sprite: renderTarget.levelController.visualEffects[index]
+        property rect frameRect
+
+        function refreshFrame() {
+          frameRect = sprite.clippedRect;
+        }
+
+        Component.onCompleted: {
+          refreshFrame();
+          visualEffectsRenderer.frames.register(sprite, visualEffectRenderer);
+        }
+        Component.onDestruction: visualEffectsRenderer.frames.unregister(sprite, visualEffectRenderer)
+
         x: sprite.spritePosition.x
         y: sprite.spritePosition.y
         source: fileProtocol + sprite.spriteSource
-        sourceClipRect: sprite.clippedRect
+        sourceClipRect: frameRect
+
+        Connections {
+          target: sprite
+          function onClippedRectChanged() {
+            visualEffectRenderer.refreshFrame();
+          }
+        }
       }
     }
 
@@ -2,26 +2,42 @@ import QtQuick 2.15
 
 Repeater {
   property QtObject levelController: renderTarget.levelController
+  property SpriteFrameRegistry frames: SpriteFrameRegistry { levelController: root.levelController }
   id: root
   delegate: Image {
     id: dynamicObjectRenderer
     property QtObject dynamicObject: root.model[index]
     property point offset: root.levelController.getAdjustedOffsetFor(dynamicObject)
+    property rect frameRect
+
+    function refreshFrame() {
+      frameRect = dynamicObject.clippedRect;
+    }
+
+    Component.onCompleted: {
+      refreshFrame();
+      root.frames.register(dynamicObject, dynamicObjectRenderer);
+    }
+    Component.onDestruction: root.frames.unregister(dynamicObject, dynamicObjectRenderer)
 
     source: fileProtocol + dynamicObject.spriteSource
-    sourceClipRect: dynamicObject.clippedRect
+    sourceClipRect: frameRect
     x: offset.x
     y: offset.y
     z: (dynamicObject.position.x + dynamicObject.position.y * renderTarget.mapSize.width) * 4 + dynamicObject.zIndex - 1
     //Text { color: "yellow"; text: parent.z }
 
-    onSourceClipRectChanged: offset = levelController.getAdjustedOffsetFor(dynamicObject)
-
     Connections {
       target: dynamicObject
       function onSpritePositionChanged() {
         dynamicObjectRenderer.offset = root.levelController.getAdjustedOffsetFor(dynamicObject);
       }
+      function onAnimationChanged() {
+        dynamicObjectRenderer.offset = root.levelController.getAdjustedOffsetFor(dynamicObject);
+      }
+      function onClippedRectChanged() {
+        dynamicObjectRenderer.refreshFrame();
+      }
     }
 
     DaylightShader {
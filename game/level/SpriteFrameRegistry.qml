@@ -0,0 +1,30 @@
+import QtQuick 2.15
+
+// Levels batch the frame changes of their sprites, and report them once per tick.
+// Delegates register here, and get refreshed when their sprite is part of a batch.
+QtObject {
+  id: root
+  property QtObject levelController
+  property var      targets: new Map()
+
+  function register(sprite, item) {
+    targets.set(sprite, item);
+  }
+
+  function unregister(sprite, item) {
+    if (targets.get(sprite) === item)
+      targets.delete(sprite);
+  }
+
+  property Connections batchListener: Connections {
+    target: root.levelController
+    function onSpriteFramesChanged(sprites) {
+      for (var i = 0 ; i < sprites.length ; ++i) {
+        const item = root.targets.get(sprites[i]);
+
+        if (item)
+          item.refreshFrame();
+      }
+    }
+  }
+}
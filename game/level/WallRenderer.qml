@@ -6,9 +6,9 @@ Item {
   property int tx: index % renderTarget.mapSize.width
   property int ty: Math.round(index / renderTarget.mapSize.width)
   readonly property point renderPosition: levelController.getRenderPositionForTile(tx, ty)
-  readonly property var block: renderTarget.blocks ? renderTarget.blocks.getTile(tx, ty) : null
-  readonly property var vwall: renderTarget.vwalls ? renderTarget.vwalls.getTile(tx, ty) : null
-  readonly property var hwall: renderTarget.hwalls ? renderTarget.hwalls.getTile(tx, ty) : null
+  readonly property var block: renderTarget.blocks ? renderTarget.blocks.getQmlTile(tx, ty) : null
+  readonly property var vwall: renderTarget.vwalls ? renderTarget.vwalls.getQmlTile(tx, ty) : null
+  readonly property var hwall: renderTarget.hwalls ? renderTarget.hwalls.getQmlTile(tx, ty) : null
   property bool rendered: isRendered(levelController.renderedTiles)
   function isRendered() { return levelController.isCaseRendered(tx, ty); }
 
@@ -18,9 +18,9 @@ Item {
   visible: rendered
 
   //Text { color: "white"; font.bold: true; text: parent.z }
-  Loader { readonly property var wall: block; sourceComponent: wall && rendered ? wallComponent : null; y: -renderTarget.wallHeight }
-  Loader { readonly property var wall: vwall; sourceComponent: wall && rendered ? wallComponent : null; y: -renderTarget.wallHeight }
-  Loader { readonly property var wall: hwall; sourceComponent: wall && rendered ? wallComponent : null; y: -renderTarget.wallHeight }
+  Loader { readonly property var wall: block; readonly property string wallType: "block"; sourceComponent: wall && rendered ? wallComponent : null; y: -renderTarget.wallHeight }
+  Loader { readonly property var wall: vwall; readonly property string wallType: "vwall"; sourceComponent: wall && rendered ? wallComponent : null; y: -renderTarget.wallHeight }
+  Loader { readonly property var wall: hwall; readonly property string wallType: "hwall"; sourceComponent: wall && rendered ? wallComponent : null; y: -renderTarget.wallHeight }
 
   Component {
     id: wallComponent
@@ -45,8 +45,8 @@ Item {
         onPositionRefreshed: {
           withClipping = levelController.player &&
             ((tx >= levelController.player.position.x && ty >= levelController.player.position.y) ||
-             (wall === hwall && tx === levelController.player.position.x - 1 && ty === levelController.player.position.y) ||
-             (wall === vwall && ty === levelController.player.position.y - 1 && tx === levelController.player.position.x));
+             (wallType === "hwall" && tx === levelController.player.position.x - 1 && ty === levelController.player.position.y) ||
+             (wallType === "vwall" && ty === levelController.player.position.y - 1 && tx === levelController.player.position.x));
         }
       }
     }
@@ -10,7 +10,7 @@ Item {
     delegate: Image {
       id: zoneTile
       property point    position: zone.getPositionAt(index)
-      property QtObject tile: ground.getTile(position.x, position.y)
+      property var      tile: ground.getQmlTile(position.x, position.y)
       property point    renderPosition: tile ? tile.renderPosition : Qt.point(0, 0)
       source: tilesetSource
       sourceClipRect: zone.clippedRect
@@ -81,7 +81,7 @@ void ActionsComponent::useSpell(const QString &spellName)
     interactionType = SpellUse;
     mouseMode = TargetCursor;
     activeSkill = spellName;
-    targetList.findNearbyTargets(allDynamicObjects());
+    targetList.findNearbyTargets(getObjectIndex().findObjectsInRange(getPlayer()->getPoint(), InteractionTargetList::nearbyRange));
     emit mouseModeChanged();
     break ;
   }
@@ -97,7 +97,7 @@ void ActionsComponent::useSkill(const QString &skill)
     activeSkill = skill;
     mouseMode = TargetCursor;
     activeItem = nullptr;
-    targetList.findNearbyTargets(allDynamicObjects());
+    targetList.findNearbyTargets(getObjectIndex().findObjectsInRange(getPlayer()->getPoint(), InteractionTargetList::nearbyRange));
     emit activeItemChanged();
     emit mouseModeChanged();
   }
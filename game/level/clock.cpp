@@ -15,6 +15,7 @@ void ClockComponent::load(const QJsonObject& data)
 
 void ClockComponent::advanceTime(unsigned int minutes)
 {
+  Sprite::beginFrameBatch();
   while (minutes-- > 0)
   {
     const qint64 delta = 60 * 1000;
@@ -33,4 +34,21 @@ void ClockComponent::advanceTime(unsigned int minutes)
     taskRunner->update(delta);
     Game::get()->getTaskManager()->update(delta);
   }
+  endFrameBatch();
+}
+
+// Renderers get a single notification listing every sprite whose frame changed
+void ClockComponent::endFrameBatch()
+{
+  QVector<Sprite*> sprites = Sprite::endFrameBatch();
+
+  if (sprites.size() > 0)
+  {
+    QVariantList list;
+
+    list.reserve(sprites.size());
+    for (Sprite* sprite : qAsConst(sprites))
+      list << QVariant::fromValue<QObject*>(sprite);
+    emit spriteFramesChanged(list);
+  }
 }
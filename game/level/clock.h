@@ -16,7 +16,12 @@ public:
 
   Q_INVOKABLE void advanceTime(unsigned int minutes);
 
+signals:
+  void spriteFramesChanged(const QVariantList& sprites);
+
 protected:
+  void endFrameBatch();
+
   TimeManager* timeManager = nullptr;
 };
 
@@ -21,15 +21,17 @@ void CursorComponent::centerCursorOn(DynamicObject *object)
 QPoint CursorComponent::getClickableOffsetFor(const DynamicObject *target) const
 {
   QPoint position = getAdjustedOffsetFor(target);
-  const QImage& image = target->getImage();
+  QImage image = target->getImage();
+  QRect  clip = target->getClippedRect().intersected(image.rect());
 
-  for (int x = 0 ; x < image.width() ; ++x)
+  // Only the current frame is looked at, not the whole texture
+  for (int x = 0 ; x < clip.width() ; ++x)
   {
-    for (int y = 0 ; y < image.height() ; ++y)
+    for (int y = 0 ; y < clip.height() ; ++y)
     {
       QPoint pixelPosition = position + QPoint(x, y);
 
-      if (image.pixelColor(x, y) != Qt::transparent && getObjectAt(pixelPosition) == target)
+      if (image.pixelColor(clip.x() + x, clip.y() + y) != Qt::transparent && getObjectAt(pixelPosition) == target)
         return pixelPosition;
     }
   }
@@ -94,7 +96,7 @@ DynamicObject* CursorComponent::getObjectAt(int posX, int posY) const
       {
         QPoint collisionAt(posX - coordinates.x(), posY - coordinates.y());
         QPoint sheetPosition(clip.x() + collisionAt.x(), clip.y() + collisionAt.y());
-        const QImage& image = object->getImage();
+        QImage image = object->getImage();
 
         if (image.pixelColor(sheetPosition) != Qt::transparent)
            return object;
@@ -13,13 +13,15 @@ class DebugComponent : public LevelBase
 public:
   explicit DebugComponent(QObject *parent = nullptr);
 
-  Q_INVOKABLE QString metricsHtml() { return performanceMetrics.html();}
+  Q_INVOKABLE QString metricsHtml() { collectMetrics(); return performanceMetrics.html();}
   Q_INVOKABLE void resetMetrics() { performanceMetrics.reset(); }
 
 signals:
   void debugModeChanged();
 
 protected:
+  virtual void       collectMetrics() {}
+
   bool               debugMode = false;
   PerformanceReport  performanceMetrics;
 };
@@ -4,6 +4,11 @@
 #include "game.h"
 #include "game/dices.hpp"
 #include "game/objects/elevator.h"
+#include "game/pathfinding/pathfindingstore.h"
+#include <QDir>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonArray>
 #include <cmath>
 
 LevelGrid* getFloorGrid(unsigned char floor)
@@ -13,6 +18,33 @@ LevelGrid* getFloorGrid(unsigned char floor)
   return level ? level->getFloorGrid(floor) : nullptr;
 }
 
+// Doorways annotate the grid once it's been loaded: their placement is part of
+// what the stored pathfinding data was computed alongside with.
+static void hashDoorways(QCryptographicHash& hash, const QJsonObject& group)
+{
+  static const QStringList placementKeys{"x", "y", "z", ">", "cover", "blocksPath"};
+
+  for (const QJsonValue& value : group["objects"].toArray())
+  {
+    if (value["type"].toString() == "Doorway")
+    {
+      for (const QString& key : placementKeys)
+        hash.addData(QJsonDocument(QJsonArray{key, value[key]}).toJson(QJsonDocument::Compact));
+    }
+  }
+  for (const QJsonValue& value : group["groups"].toArray())
+    hashDoorways(hash, value.toObject());
+}
+
+static QByteArray pathfindingSourceHash(const TileMap* tilemap, const QJsonObject& data)
+{
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+
+  hash.addData(tilemap->getSourceHash());
+  hashDoorways(hash, data);
+  return hash.result();
+}
+
 GridComponent::GridComponent(QObject *parent) : ParentType(parent)
 {
   grid = new LevelGrid(this);
@@ -24,28 +56,49 @@ void GridComponent::load(const QJsonObject& data)
 
   if (tilemap->load(data["name"].toString()))
   {
+    QVector<TileMap*> tilemaps{tilemap};
+    PathfindingStore  store(getPathfindingCachePath(data["name"].toString()), pathfindingSourceHash(tilemap, data));
+
     for (TileLayer* layer : tilemap->getRoofs())
       connect(layer, &TileLayer::visibleChanged, [this, layer]() { onRoofVisibilityChanged(layer); });
-    grid->initializeGrid(tilemap);
     floors.push_back(grid);
     for (FloorLayer* layer : tilemap->getFloors())
     {
-      LevelGrid* floorGrid = new LevelGrid(this);
-
-      floorGrid->initializeGrid(layer->getTileMap());
-      if (!floorGrid->getTilemap()->getLayer("ground"))
+      if (!layer->getTileMap()->getLayer("ground"))
         throw std::runtime_error("Missing ground layer in tilemap");
-      floors.push_back(floorGrid);
+      floors.push_back(new LevelGrid(this));
+      tilemaps.push_back(layer->getTileMap());
+    }
+    if (!usePathfindingCache() || !store.load(floors, tilemaps, pathfinding))
+    {
+      for (int i = 0 ; i < floors.size() ; ++i)
+        floors[i]->initializeGrid(tilemaps[i]);
+      pathfinding.prepareZoneGrid(floors);
+      if (usePathfindingCache())
+        store.save(floors, pathfinding);
     }
     currentFloor = static_cast<unsigned char>(data["currentFloor"].toInt(0));
     emit floorChanged();
-    pathfinding.prepareZoneGrid(floors);
     ParentType::load(data);
   }
   else
     throw std::runtime_error("Could not load tilemap");
 }
 
+QString GridComponent::getPathfindingCachePath(const QString& levelName) const
+{
+  return QDir::currentPath() + "/.prerender/" + levelName + '/';
+}
+
+bool GridComponent::usePathfindingCache() const
+{
+#ifdef GAME_EDITOR
+  return false;
+#else
+  return true;
+#endif
+}
+
 void GridComponent::save(QJsonObject& data) const
 {
   data["currentFloor"] = static_cast<int>(currentFloor);
@@ -94,8 +147,11 @@ void GridComponent::registerDynamicObject(DynamicObject* object)
     elevator->connectCases();
   }
   objectObservers.insert(object, {
-    connect(object, &DynamicObject::blocksPathChanged, this, std::bind(&GridComponent::onPathBlockedChanged, this, object))
+    connect(object, &DynamicObject::blocksPathChanged, this, std::bind(&GridComponent::onPathBlockedChanged, this, object)),
+    connect(object, &DynamicObject::positionChanged,   this, std::bind(&ObjectIndex::update, &objectIndex, object)),
+    connect(object, &DynamicObject::floorChanged,      this, std::bind(&ObjectIndex::update, &objectIndex, object))
   });
+  objectIndex.insert(object);
   ParentType::registerDynamicObject(object);
 }
 
@@ -120,10 +176,23 @@ void GridComponent::unregisterDynamicObject(DynamicObject* object)
   }
   for (auto observer : objectObservers.value(object))
     disconnect(observer);
+  objectObservers.remove(object);
+  objectIndex.remove(object);
   setBlockPathBeahviour(object, false);
   ParentType::unregisterDynamicObject(object);
 }
 
+void GridComponent::collectMetrics()
+{
+  const PathCache::Statistics& statistics = pathfinding.cache.getStatistics();
+
+  performanceMetrics.setCounter("Path cache: route hits",     statistics.routeHits);
+  performanceMetrics.setCounter("Path cache: route misses",   statistics.routeMisses);
+  performanceMetrics.setCounter("Path cache: segment hits",   statistics.segmentHits);
+  performanceMetrics.setCounter("Path cache: segment misses", statistics.segmentMisses);
+  ParentType::collectMetrics();
+}
+
 void GridComponent::addCharacterObserver(Character* character, QMetaObject::Connection observer)
 {
   characterObservers[character].push_back(observer);
@@ -318,10 +387,7 @@ QJSValue GridComponent::getDynamicObjectsAt(int x, int y, unsigned int floor_) c
   unsigned char objectFloor = static_cast<int>(floor_) < floors.size() ? static_cast<unsigned char>(floor_) : currentFloor;
   QJSValue      result = scriptEngine.newArray();
   QJSValue      push = result.property("push");
-  QPoint        position(x, y);
-  const auto    objectList = findDynamicObjects(
-    [position, objectFloor](DynamicObject& object) { return object.getPosition() == position && object.getCurrentFloor() == objectFloor; }
-  );
+  const auto    objectList = objectIndex.findObjectsAt(Point{x, y, objectFloor});
 
   for (DynamicObject* object : objectList)
     push.callWithInstance(result, QJSValueList() << object->asJSValue());
@@ -330,18 +396,16 @@ QJSValue GridComponent::getDynamicObjectsAt(int x, int y, unsigned int floor_) c
 
 QVector<DynamicObject*> GridComponent::getDynamicObjectsAt(Point position) const
 {
-  return findDynamicObjects(
-    [position](DynamicObject& object) { return object.getPoint() == position; }
-  );
+  return objectIndex.findObjectsAt(position);
 }
 
 QPoint GridComponent::getRenderPositionForTile(int x, int y, unsigned char z)
 {
   auto* grid  = z != NULL_FLOOR ? getFloorGrid(z) : getGrid();
   auto* layer = grid  ? grid->getTilemap()->getLayer("ground") : nullptr;
-  auto* tile  = layer ? layer->getTile(x, y) : nullptr;
+  Tile  tile  = layer ? layer->getTile(x, y) : Tile();
 
-  return tile ? tile->getRenderPosition() : QPoint();
+  return tile ? tile.getRenderPosition() : QPoint();
 }
 
 float GridComponent::getDistance(QPoint pa, QPoint pb) const
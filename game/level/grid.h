@@ -5,6 +5,7 @@
 # include "debug.h"
 # include "../pathfinding/levelgrid.h"
 # include "../pathfinding/zonegrid.h"
+# include "objectindex.h"
 
 class TileLayer;
 class CharacterParty;
@@ -61,6 +62,7 @@ public:
   }
 
   ZoneGrid& getPathfinder() { return pathfinding; }
+  const ObjectIndex& getObjectIndex() const { return objectIndex; }
 
 signals:
   void floorChanged();
@@ -71,11 +73,14 @@ protected slots:
   void         onPathBlockedChanged(DynamicObject*);
 
 protected:
+  void collectMetrics() override;
   void addCharacterObserver(Character*, QMetaObject::Connection);
   void setGridObjectPosition(DynamicObject*, int x, int y, unsigned char floor);
   void setRenderObjectPosition(DynamicObject*, int x, int y);
   void setBlockPathBeahviour(DynamicObject*, bool blockPath);
   static bool isRenderedBefore(const DynamicObject*, const DynamicObject*);
+  virtual bool usePathfindingCache() const;
+  QString      getPathfindingCachePath(const QString& levelName) const;
 
   LevelGrid* grid = nullptr;
 private:
@@ -84,6 +89,7 @@ private:
   unsigned char currentFloor = 0;
   QVector<LevelGrid*> floors;
   ZoneGrid pathfinding;
+  ObjectIndex objectIndex;
 };
 
 #endif // GRIDCOMPONENT_H
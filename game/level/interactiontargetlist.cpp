@@ -73,7 +73,7 @@ void InteractionTargetList::findNearbyTargets(const QVector<DynamicObject*> obje
     bool isHiddenCharacter = isHiddenLevel || (object->isCharacter() && !player->getFieldOfView()->isDetected(reinterpret_cast<Character*>(object)));
     bool isHiddenObject    = isHiddenCharacter || object->isHidden();
 
-    if (!isHiddenObject && player->getDistance(object) < 20)
+    if (!isHiddenObject && player->getDistance(object) < nearbyRange)
       targets.push_back(object);
   }
   if (targets.size() > 0)
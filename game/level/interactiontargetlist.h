@@ -11,6 +11,8 @@ class InteractionTargetList : public QObject
   Q_PROPERTY(unsigned int cursor READ getCursor NOTIFY cursorChanged)
   Q_PROPERTY(QQmlListProperty<DynamicObject> targets READ getQmlTargets NOTIFY targetsUpdated)
 public:
+  static const int nearbyRange = 20;
+
   explicit InteractionTargetList(QObject* parent = nullptr);
 
   Q_INVOKABLE DynamicObject* nextTarget();
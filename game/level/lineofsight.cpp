@@ -1,67 +1,115 @@
 #include "../pathfinding/levelgrid.h"
 #include "../dynamicobject.h"
 #include <cmath>
-#include <QLineF>
-#include <QRectF>
+#include <limits>
 #include <QDebug>
 
-static bool lineIntersectsRect(QLineF line, QRectF rect)
+/*
+ * Sight lines go from the top-left corner of the observer's case to the top-left corner
+ * of the target's case, with cases being one unit wide. Every case of the bounding box
+ * whose area is touched by the line, edges and corners included, may provide cover.
+ * These cases are visited column by column using integer arithmetic only, so that a
+ * query costs O(distance) instead of O(dx * dy).
+ */
+struct SightLine
 {
-  QLineF leftSide(rect.topLeft(), rect.bottomLeft());
-  QLineF topSide(rect.topLeft(), rect.topRight());
-  QLineF rightSide(rect.topRight(), rect.bottomRight());
-  QLineF bottomSide(rect.bottomLeft(), rect.bottomRight());
-
-  return (leftSide.intersects(line, nullptr)   == QLineF::BoundedIntersection) ||
-         (topSide.intersects(line, nullptr)    == QLineF::BoundedIntersection) ||
-         (rightSide.intersects(line, nullptr)  == QLineF::BoundedIntersection) ||
-         (bottomSide.intersects(line, nullptr) == QLineF::BoundedIntersection);
-}
+  SightLine(int fromX, int fromY, int toX, int toY) :
+    fromX(fromX), fromY(fromY), toX(toX), toY(toY),
+    dx(toX - fromX), dy(toY - fromY),
+    minX(std::min(fromX, toX)), minY(std::min(fromY, toY)),
+    maxX(std::max(fromX, toX)), maxY(std::max(fromY, toY))
+  {}
 
-static bool losIntersectsWithHWall(QLineF line, QRectF rect)
-{
-  QLineF bottomSide(rect.bottomLeft(), rect.bottomRight());
+  // Numerator of the y coordinate of the line at x = u, over a denominator of |dx|
+  long yNumeratorAt(int u) const
+  {
+    long numerator = static_cast<long>(fromY) * dx + static_cast<long>(dy) * (u - fromX);
 
-  return bottomSide.intersects(line, nullptr) == QLineF::BoundedIntersection;
-}
+    return dx < 0 ? -numerator : numerator;
+  }
 
-static bool losIntersectsWithVWall(QLineF line, QRectF rect)
-{
-  QLineF rightSide(rect.topRight(), rect.bottomRight());
+  // Whether the line crosses the bottom edge of the case at (x, y)
+  bool crossesBottomSide(int x, int y) const
+  {
+    int  v = y + 1;
+    long numerator, denominator;
 
-  return rightSide.intersects(line, nullptr) == QLineF::BoundedIntersection;
-}
-/*
-static int sightOrientation(int fromX, int fromY, int toX, int toY)
-{
-  int dir = OrientedSprite::NoDir;
-
-  if (fromX < toX)
-    dir |=  OrientedSprite::RightDir;
-  else if (toX < fromX)
-    dir |= OrientedSprite::LeftDir;
-  if (fromY < toY)
-    dir |= OrientedSprite::BottomDir;
-  else if (toY < fromY)
-    dir |= OrientedSprite::UpperDir;
-  return dir;
-}
-*/
-static QPair<char, char> getCoverThroughCase(const LevelGrid::CaseContent* gridCase, const QLineF sightLine, const QRectF caseRect, const QPoint from, const QPoint target)
+    if (dy == 0 || v < minY || v > maxY)
+      return false;
+    numerator   = static_cast<long>(fromX) * dy + static_cast<long>(dx) * (v - fromY);
+    denominator = dy;
+    if (denominator < 0)
+    {
+      numerator   = -numerator;
+      denominator = -denominator;
+    }
+    return x * denominator <= numerator && numerator <= (x + 1) * denominator;
+  }
+
+  // Whether the line crosses the right edge of the case at (x, y)
+  bool crossesRightSide(int x, int y) const
+  {
+    int  u = x + 1;
+    long numerator, denominator;
+
+    if (dx == 0 || u < minX || u > maxX)
+      return false;
+    numerator   = yNumeratorAt(u);
+    denominator = std::abs(dx);
+    return y * denominator <= numerator && numerator <= (y + 1) * denominator;
+  }
+
+  template<typename FUNCTOR>
+  bool eachCase(FUNCTOR callback) const
+  {
+    if (dx == 0)
+    {
+      for (int y = minY ; y <= maxY ; ++y)
+      {
+        if (!callback(fromX, y))
+          return false;
+      }
+      return true;
+    }
+    for (int x = minX ; x <= maxX ; ++x)
+    {
+      long a = yNumeratorAt(x);
+      long b = yNumeratorAt(std::min(x + 1, maxX));
+      long low = std::min(a, b), high = std::max(a, b);
+      long denominator = std::abs(dx);
+      int  firstY = std::max(minY, static_cast<int>((low + denominator - 1) / denominator) - 1);
+      int  lastY  = std::min(maxY, static_cast<int>(high / denominator));
+
+      for (int y = firstY ; y <= lastY ; ++y)
+      {
+        if (!callback(x, y))
+          return false;
+      }
+    }
+    return true;
+  }
+
+  const int fromX, fromY, toX, toY;
+  const int dx, dy;
+  const int minX, minY, maxX, maxY;
+};
+
+static QPair<char, char> getCoverThroughCase(const LevelGrid::CaseContent* gridCase, const SightLine& sightLine)
 {
-  bool isFrom   = gridCase->position == from;
-  bool isTarget = gridCase->position == target;
+  const int x = gridCase->position.x, y = gridCase->position.y;
+  bool isFrom   = x == sightLine.fromX && y == sightLine.fromY;
+  bool isTarget = x == sightLine.toX   && y == sightLine.toY;
   char cover = 0;
   char obstacleCount = 0;
 
   if (gridCase->block)
     obstacleCount++;
-  if (gridCase->hwall && losIntersectsWithHWall(sightLine, caseRect))
+  if (gridCase->hwall && sightLine.crossesBottomSide(x, y))
   {
     cover = std::max(cover, gridCase->hcover);
     obstacleCount++;
   }
-  if (gridCase->vwall && losIntersectsWithVWall(sightLine, caseRect))
+  if (gridCase->vwall && sightLine.crossesRightSide(x, y))
   {
     cover = std::max(cover, gridCase->vcover);
     obstacleCount++;
@@ -83,44 +131,97 @@ static bool ignoreCover(int fromX, int fromY, int caseX, int caseY)
   return std::abs(fromX - caseX) <= 1 && std::abs(fromY - caseY) <= 1;
 }
 
+void LevelGrid::initializeSightPlane()
+{
+  int rows = (size.height() + sightChunkSize - 1) / sightChunkSize;
+
+  sightPlane.resize(grid.size());
+  sightChunkColumns = (size.width() + sightChunkSize - 1) / sightChunkSize;
+  sightChunks.fill(++sightRevision, sightChunkColumns * rows);
+  for (const CaseContent& gridCase : qAsConst(grid))
+    updateSightPlane(gridCase);
+}
+
+void LevelGrid::updateSightPlane(const CaseContent& gridCase)
+{
+  int index = indexOf(gridCase);
+  int chunk = (gridCase.position.y / sightChunkSize) * sightChunkColumns + gridCase.position.x / sightChunkSize;
+
+  if (index >= 0 && index < sightPlane.size())
+  {
+    sightPlane[index] = (gridCase.cover                   ? SightCover    : 0)
+                      | (gridCase.hwall || gridCase.hcover ? SightHWall    : 0)
+                      | (gridCase.vwall || gridCase.vcover ? SightVWall    : 0)
+                      | (gridCase.block                   ? SightBlock    : 0)
+                      | (gridCase.occupant                ? SightOccupant : 0);
+  }
+  if (chunk >= 0 && chunk < sightChunks.size())
+    sightChunks[chunk] = ++sightRevision;
+}
+
+// Latest revision at which a case of the bounding box of from and to changed.
+// Sight lines never leave that box, so traces older than it are still valid.
+quint32 LevelGrid::getSightRevision(QPoint from, QPoint to) const
+{
+  const int rows        = sightChunkColumns > 0 ? sightChunks.size() / sightChunkColumns : 0;
+  const int firstColumn = std::max(0, std::min(from.x(), to.x()) / sightChunkSize);
+  const int lastColumn  = std::min(sightChunkColumns - 1, std::max(from.x(), to.x()) / sightChunkSize);
+  const int firstRow    = std::max(0, std::min(from.y(), to.y()) / sightChunkSize);
+  const int lastRow     = std::min(rows - 1, std::max(from.y(), to.y()) / sightChunkSize);
+  quint32   result = 0;
+
+  if (sightChunks.isEmpty())
+    return std::numeric_limits<quint32>::max();
+  for (int row = firstRow ; row <= lastRow ; ++row)
+  {
+    for (int column = firstColumn ; column <= lastColumn ; ++column)
+      result = std::max(result, sightChunks[row * sightChunkColumns + column]);
+  }
+  return result;
+}
+
 int LevelGrid::getVisionQuality(int fromX, int fromY, int toX, int toY)
 {
-  const qreal   caseSize = 10;
-  const int     minX = std::min(fromX, toX), minY = std::min(fromY, toY);
-  const int     maxX = std::max(fromX, toX), maxY = std::max(fromY, toY);
-  const QPointF sightFrom(static_cast<qreal>(fromX - minX) * caseSize, static_cast<qreal>(fromY - minY) * caseSize);
-  const QPointF sightTo  (static_cast<qreal>(toX - minX) * caseSize,   static_cast<qreal>(toY - minY) * caseSize);
-  const QLineF  sightLine(sightFrom, sightTo);
+  const SightLine sightLine(fromX, fromY, toX, toY);
+  const bool      hasSightPlane = sightPlane.size() == grid.size();
   char  cover = 0;
   char  obstacleCount = 0;
+  bool  visible;
 
-  for (int x = minX ; x <= maxX ; ++x)
+  visible = sightLine.eachCase([&](int x, int y) -> bool
   {
-    for (int y = minY ; y <= maxY ; ++y)
+    int index = y * size.width() + x;
+    LevelGrid::CaseContent* gridCase;
+
+    if (x < 0 || y < 0 || x >= size.width() || y >= size.height())
+      return true;
+    if (hasSightPlane && sightPlane[index] == 0)
+      return true;
+    gridCase = &grid[index];
+    if (!gridCase->occupant && (gridCase->cover + gridCase->hcover + gridCase->vcover) == 0)
+      return true;
+
+    auto result = getCoverThroughCase(gridCase, sightLine);
+
+    if (result.first >= 100)
+      return false;
+    else if (!ignoreCover(fromX, fromY, x, y))
     {
-      LevelGrid::CaseContent* gridCase;
-      qreal posX, posY;
-      QRectF caseRect;
-
-      gridCase = getGridCase(x, y);
-      if (!gridCase || (!gridCase->occupant && (gridCase->cover + gridCase->hcover + gridCase->vcover) == 0))
-        continue ;
-      posX = static_cast<qreal>(x - minX) * 10;
-      posY = static_cast<qreal>(y - minY) * 10;
-      caseRect = QRectF(posX, posY, caseSize, caseSize);
-      if (lineIntersectsRect(sightLine, caseRect))
-      {
-        auto result = getCoverThroughCase(gridCase, sightLine, caseRect, {fromX, fromY}, {toX, toY});
-
-        if (result.first >= 100)
-          return 0;
-        else if (!ignoreCover(fromX, fromY, gridCase->position.x, gridCase->position.y))
-        {
-          cover = std::max(cover, result.first);
-          obstacleCount += result.second;
-        }
-      }
+      cover = std::max(cover, result.first);
+      obstacleCount += result.second;
     }
-  }
-  return std::max(0, 100 - (cover + obstacleCount));
+    return true;
+  });
+  return visible ? std::max(0, 100 - (cover + obstacleCount)) : 0;
+}
+
+// Batch form used by perception: one observer against several targets
+QVector<int> LevelGrid::getVisionQualities(QPoint from, const QVector<QPoint>& targets)
+{
+  QVector<int> qualities;
+
+  qualities.reserve(targets.size());
+  for (QPoint target : targets)
+    qualities << getVisionQuality(from.x(), from.y(), target.x(), target.y());
+  return qualities;
 }
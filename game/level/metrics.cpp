@@ -5,13 +5,28 @@ QString PerformanceReport::html()
 {
   QString out("<table width=\"390\">");
 
+  for (auto it = counters.begin() ; it != counters.end() ; ++it)
+  {
+    out += "<tr>";
+    out += "<th style=\"text-align:left\" width=\"290\">" + it.key() + "</th>";
+    out += "<td style=\"text-align:right\" width=\"90\">" + QString::number(it.value()) + "</td></tr>";
+  }
+  for (auto it = deferredWork.begin() ; it != deferredWork.end() ; ++it)
+  {
+    out += "<tr>";
+    out += "<th style=\"text-align:left\" width=\"290\">Deferred " + it.key() + " (" + QString::number(it->ticks) + " ticks)</th>";
+    out += "<td style=\"text-align:right\" width=\"90\">" + QString::number(it->updates) + " / " + QString::number(it->time) + "ms</td></tr>";
+  }
   std::sort(objects.begin(), objects.end());
   for (auto it = objects.begin() ; it != objects.end() ; ++it)
   {
     double v = static_cast<double>(it->time) / 1000;
     out += "<tr>";
     out += "<th style=\"text-align:left\" width=\"290\">" + it->object->getPath() + "</th>";
-    out += "<td style=\"text-align:right\" width=\"90\">" + QString::number(v, 'f', 3) + "s</td></tr>";
+    out += "<td style=\"text-align:right\" width=\"90\">" + QString::number(v, 'f', 3) + "s";
+    if (it->deferred > 0)
+      out += " (" + QString::number(it->deferred) + " deferred)";
+    out += "</td></tr>";
   }
   return out + "</table>";
 }
@@ -36,9 +51,23 @@ void PerformanceReport::removeObject(const DynamicObject* object)
     objects.erase(it);
 }
 
+void PerformanceReport::addDeferredWork(const QString& name, unsigned int updates, qint64 time)
+{
+  DeferredWorkReport& report = deferredWork[name];
+
+  report.updates += updates;
+  report.time    += time;
+  if (updates > 0)
+    report.ticks++;
+}
+
 void PerformanceReport::reset()
 {
   for (auto it = objects.begin() ; it != objects.end() ; ++it)
+  {
     it->time = 0;
+    it->deferred = 0;
+  }
+  deferredWork.clear();
 }
 
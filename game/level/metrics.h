@@ -2,6 +2,7 @@
 # define LEVEL_METRICS_H
 
 # include <QVector>
+# include <QMap>
 # include <QElapsedTimer>
 
 class DynamicObject;
@@ -15,6 +16,7 @@ struct ObjectPerformanceReport
 
   const DynamicObject* object;
   qint64               time = 0;
+  unsigned int         deferred = 0;
 };
 
 struct ObjectPerformanceClock
@@ -33,14 +35,25 @@ struct ObjectPerformanceClock
   ObjectPerformanceReport& report;
 };
 
+struct DeferredWorkReport
+{
+  unsigned int updates = 0;
+  qint64       time = 0;
+  unsigned int ticks = 0;
+};
+
 struct PerformanceReport
 {
   QString                  html();
   ObjectPerformanceReport& object(const DynamicObject* object);
   void                     reset();
   void                     removeObject(const DynamicObject* object);
+  void                     setCounter(const QString& name, qint64 value) { counters[name] = value; }
+  void                     addDeferredWork(const QString& name, unsigned int updates, qint64 time);
 
-  QVector<ObjectPerformanceReport> objects;
+  QVector<ObjectPerformanceReport>  objects;
+  QMap<QString, qint64>             counters;
+  QMap<QString, DeferredWorkReport> deferredWork;
 };
 
 #endif
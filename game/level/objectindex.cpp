@@ -0,0 +1,106 @@
+#include "objectindex.h"
+#include "game/dynamicobject.h"
+
+quint64 ObjectIndex::chunkKey(int chunkX, int chunkY, unsigned char floor)
+{
+  return (static_cast<quint64>(floor) << 48)
+       | (static_cast<quint64>(static_cast<quint16>(chunkY)) << 24)
+       | static_cast<quint64>(static_cast<quint16>(chunkX));
+}
+
+void ObjectIndex::clear()
+{
+  chunks.clear();
+  entries.clear();
+}
+
+void ObjectIndex::insert(DynamicObject* object)
+{
+  Point   position = object->getPoint();
+  quint64 chunk    = chunkKey(chunkOf(position.x), chunkOf(position.y), position.z);
+
+  if (!entries.contains(object))
+  {
+    entries.insert(object, {position, chunk});
+    chunks[chunk].push_back(object);
+  }
+}
+
+void ObjectIndex::update(DynamicObject* object)
+{
+  auto it = entries.find(object);
+
+  if (it != entries.end())
+  {
+    Point   position = object->getPoint();
+    quint64 chunk    = chunkKey(chunkOf(position.x), chunkOf(position.y), position.z);
+
+    if (chunk != it->chunk)
+    {
+      auto bucket = chunks.find(it->chunk);
+
+      if (bucket != chunks.end())
+      {
+        bucket->removeOne(object);
+        if (bucket->isEmpty())
+          chunks.erase(bucket);
+      }
+      chunks[chunk].push_back(object);
+      it->chunk = chunk;
+    }
+    it->position = position;
+  }
+}
+
+void ObjectIndex::remove(DynamicObject* object)
+{
+  auto it = entries.find(object);
+
+  if (it != entries.end())
+  {
+    auto bucket = chunks.find(it->chunk);
+
+    if (bucket != chunks.end())
+    {
+      bucket->removeOne(object);
+      if (bucket->isEmpty())
+        chunks.erase(bucket);
+    }
+    entries.erase(it);
+  }
+}
+
+QVector<DynamicObject*> ObjectIndex::findObjectsAt(Point position) const
+{
+  return findObjectsInRect(QRect(position.x, position.y, 1, 1), position.z);
+}
+
+QVector<DynamicObject*> ObjectIndex::findObjectsInRect(QRect rect, unsigned char floor) const
+{
+  QVector<DynamicObject*> results;
+
+  for (int chunkX = chunkOf(rect.left()) ; chunkX <= chunkOf(rect.right()) ; ++chunkX)
+  {
+    for (int chunkY = chunkOf(rect.top()) ; chunkY <= chunkOf(rect.bottom()) ; ++chunkY)
+    {
+      auto bucket = chunks.constFind(chunkKey(chunkX, chunkY, floor));
+
+      if (bucket == chunks.constEnd())
+        continue ;
+      for (DynamicObject* object : *bucket)
+      {
+        const Point& position = entries.value(object).position;
+
+        if (rect.contains(position.x, position.y))
+          results << object;
+      }
+    }
+  }
+  return results;
+}
+
+// Range uses the same metric as CharacterSight::getDistance: the number of moves on the grid
+QVector<DynamicObject*> ObjectIndex::findObjectsInRange(Point center, int range) const
+{
+  return findObjectsInRect(QRect(center.x - range, center.y - range, range * 2 + 1, range * 2 + 1), center.z);
+}
@@ -0,0 +1,42 @@
+#ifndef  OBJECTINDEX_H
+# define OBJECTINDEX_H
+
+# include <QHash>
+# include <QVector>
+# include <QRect>
+# include "utils/point.h"
+
+class DynamicObject;
+
+// Buckets the dynamic objects of each floor by chunks of chunkSize x chunkSize cases,
+// so that position queries only visit the chunks they overlap instead of every object
+// of the level. The index remembers where each object was filed, which is what gets
+// used to move or remove it, whatever its current position is.
+class ObjectIndex
+{
+  static const int chunkSize = 8;
+
+  struct Entry
+  {
+    Point   position;
+    quint64 chunk;
+  };
+public:
+  void clear();
+  void insert(DynamicObject*);
+  void update(DynamicObject*);
+  void remove(DynamicObject*);
+
+  QVector<DynamicObject*> findObjectsAt(Point) const;
+  QVector<DynamicObject*> findObjectsInRect(QRect, unsigned char floor) const;
+  QVector<DynamicObject*> findObjectsInRange(Point center, int range) const;
+
+private:
+  static quint64 chunkKey(int chunkX, int chunkY, unsigned char floor);
+  static int     chunkOf(int value) { return value >= 0 ? value / chunkSize : (value + 1) / chunkSize - 1; }
+
+  QHash<quint64, QVector<DynamicObject*>> chunks;
+  QHash<DynamicObject*, Entry>            entries;
+};
+
+#endif // OBJECTINDEX_H
@@ -0,0 +1,47 @@
+#include "parallelupdate.h"
+#include "game/dynamicobject.h"
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <QThread>
+#include <algorithm>
+
+ParallelUpdate::ParallelUpdate()
+{
+  pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+}
+
+static void computeBatches(const QVector<ParallelUpdate::Job>& jobs, QAtomicInt& cursor)
+{
+  int begin;
+
+  while ((begin = cursor.fetchAndAddRelaxed(ParallelUpdate::batchSize)) < jobs.size())
+  {
+    int end = std::min(begin + static_cast<int>(ParallelUpdate::batchSize), jobs.size());
+
+    for (int i = begin ; i < end ; ++i)
+      jobs.at(i).object->computeUpdate(jobs.at(i).delta);
+  }
+}
+
+void ParallelUpdate::compute(const QVector<Job>& jobs)
+{
+  QElapsedTimer timer;
+
+  timer.start();
+  if (jobs.size() < minimumParallelJobs)
+  {
+    for (const Job& job : jobs)
+      job.object->computeUpdate(job.delta);
+  }
+  else
+  {
+    QAtomicInt cursor(0);
+    int        workerCount = std::min(pool.maxThreadCount(), jobs.size() / static_cast<int>(batchSize));
+
+    for (int i = 0 ; i < workerCount ; ++i)
+      pool.start([&jobs, &cursor]() { computeBatches(jobs, cursor); });
+    computeBatches(jobs, cursor);
+    pool.waitForDone();
+  }
+  lastComputeTime = timer.elapsed();
+}
@@ -0,0 +1,43 @@
+#ifndef  LEVEL_PARALLELUPDATE_H
+# define LEVEL_PARALLELUPDATE_H
+
+# include <QVector>
+# include <QThreadPool>
+
+class DynamicObject;
+
+// Runs the compute phase of the per-object updates on a thread pool. Workers, and
+// the calling thread, pull small batches of objects from a shared cursor until
+// none are left, so that slower objects don't hold up a whole thread's share.
+//
+// Parallel-safety contract:
+// - DynamicObject::computeUpdate may only read and write state owned by the object
+//   itself: the sprite animation and the movement interpolation. It must not emit
+//   signals, call scripts, touch the level or look at other objects.
+// - DynamicObject::applyUpdate emits whatever the compute phase recorded, and may do
+//   anything else. It runs on the main thread, once every object has been computed.
+// - Task runners (buffs included) and field of view updates run scripts or query the
+//   level as soon as their countdown expires: they stay on the main thread.
+class ParallelUpdate
+{
+public:
+  struct Job
+  {
+    DynamicObject* object;
+    qint64         delta;
+  };
+
+  static const int minimumParallelJobs = 32;
+  static const int batchSize           = 8;
+
+  ParallelUpdate();
+
+  void   compute(const QVector<Job>& jobs);
+  qint64 getLastComputeTime() const { return lastComputeTime; }
+
+private:
+  QThreadPool pool;
+  qint64      lastComputeTime = 0;
+};
+
+#endif
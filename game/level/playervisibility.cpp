@@ -1,6 +1,7 @@
 #include "playervisibility.h"
+#include <cmath>
 
-PlayerVisibilityComponent::PlayerVisibilityComponent(QObject* parent) : ParentType(parent)
+PlayerVisibilityComponent::PlayerVisibilityComponent(QObject* parent) : ParentType(parent), visibility(*this)
 {
   connect(this, &GridComponent::floorChanged, this, &PlayerVisibilityComponent::visibleObjectsChanged,    Qt::QueuedConnection);
   connect(this, &GridComponent::floorChanged, this, &PlayerVisibilityComponent::visibleCharactersChanged, Qt::QueuedConnection);
@@ -8,6 +9,12 @@ PlayerVisibilityComponent::PlayerVisibilityComponent(QObject* parent) : ParentTy
   connect(this, &LevelBase::attachedObjectsChanged, this, &PlayerVisibilityComponent::visibleCharactersChanged, Qt::QueuedConnection);
 };
 
+void PlayerVisibilityComponent::update(qint64 delta)
+{
+  visibility.refresh();
+  ParentType::update(delta);
+}
+
 void PlayerVisibilityComponent::registerDynamicObject(DynamicObject* object)
 {
   ParentType::registerDynamicObject(object);
@@ -78,16 +85,18 @@ void PlayerVisibilityComponent::refreshHiddenObjectsDetection()
   bool       withDetection = false;
   Character* player = getPlayer();
   float      radius = player->getFieldOfView()->GetRadius();
-  const auto hiddenObjects = findDynamicObjects([player, radius](DynamicObject& candidate) -> bool
+  const auto candidates = getObjectIndex().findObjectsInRange(player->getPoint(), static_cast<int>(std::ceil(radius)));
+
+  // Sight requires both ends on the same floor, so only the player's floor is searched
+  for (DynamicObject* candidate : candidates)
   {
-    return candidate.isHidden()
-        && candidate.isSneaking()
-        && !candidate.isCharacter()
-        && player->getDistance(&candidate) <= radius
-        && player->hasLineOfSight(&candidate);
-  });
-  for (auto* hiddenObject : hiddenObjects)
-    withDetection = hiddenObject->tryDetection(player) || withDetection;
+    if (candidate->isHidden()
+     && candidate->isSneaking()
+     && !candidate->isCharacter()
+     && player->getDistance(candidate) <= radius
+     && player->hasLineOfSight(candidate))
+      withDetection = candidate->tryDetection(player) || withDetection;
+  }
   if (withDetection)
     emit visibleObjectsChanged();
 }
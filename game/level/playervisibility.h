@@ -2,6 +2,7 @@
 # define PLAYERVISIBILITYCOMPONENT_H
 
 # include "ambientlightcomponent.h"
+# include "visibilitymatrix.h"
 
 class PlayerVisibilityComponent : public AmbientLightComponent
 {
@@ -14,8 +15,10 @@ public:
   PlayerVisibilityComponent(QObject* parent = nullptr);
 
   void load(const QJsonObject&);
+  void update(qint64);
   virtual void registerDynamicObject(DynamicObject*);
   virtual void unregisterDynamicObject(DynamicObject*);
+  VisibilityMatrix& getVisibility() { return visibility; }
 
 signals:
   void visibleCharactersChanged();
@@ -32,6 +35,7 @@ private:
 protected:
   QList<Character*>     visibleCharacters;
   QList<DynamicObject*> visibleObjects;
+  VisibilityMatrix      visibility;
 };
 
 #endif // PLAYERVISIBILITYCOMPONENT_H
@@ -2,6 +2,14 @@
 #include "tilemap/tilelayer.h"
 #include "tilemap/tilemap.h"
 #include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QThreadPool>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <algorithm>
 
 PreRenderComponent::PreRenderComponent(QObject* parent) : ParentType(parent)
 {
@@ -9,10 +17,13 @@ PreRenderComponent::PreRenderComponent(QObject* parent) : ParentType(parent)
 
 void PreRenderComponent::load(const QJsonObject& data)
 {
-  QDir dir;
-  QList<TileLayer*> layers;
+  QList<TileLayer*>     layers;
+  QVector<PreRenderJob> jobs;
+  QJsonObject           manifest = loadManifest();
+  unsigned int          i = 0;
 
   ParentType::load(data);
+  QDir().mkpath(getPreRenderPath());
   for (LevelGrid* grid : getFloors())
   {
     TileLayer* ground = grid->getTilemap()->getLayer("ground");
@@ -21,12 +32,24 @@ void PreRenderComponent::load(const QJsonObject& data)
       layers << ground;
     layers << grid->getTilemap()->getRoofs()
            << grid->getTilemap()->getLights();
+    collectTilemapJobs(grid->getTilemap(), "floor" + QString::number(i), jobs);
+    ++i;
+  }
+  // Only the outputs whose content changed since they were last rendered are rendered again
+  if (usePrerenderCache())
+  {
+    jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [&manifest](const PreRenderJob& job)
+    {
+      return manifest[job.key].toString() == QString::fromLatin1(job.hash.toHex()) && QFile::exists(job.output);
+    }), jobs.end());
+  }
+  if (jobs.size() > 0)
+  {
+    runJobs(jobs);
+    for (const PreRenderJob& job : qAsConst(jobs))
+      manifest[job.key] = QString::fromLatin1(job.hash.toHex());
+    saveManifest(manifest);
   }
-#ifdef GAME_EDITOR
-  clearCache();
-#endif
-  if (!dir.exists(getPreRenderPath()))
-    preRenderAllTilemaps();
   for (TileLayer* layer : layers)
     layer->setProperty("prerendered", true);
 }
@@ -36,62 +59,159 @@ QString PreRenderComponent::getPreRenderPath() const
   return QDir::currentPath() + "/.prerender/" + name + '/';
 }
 
-bool PreRenderComponent::clearCache() const
+QJsonObject PreRenderComponent::loadManifest() const
 {
-  QDir directory(getPreRenderPath());
+  QFile file(getPreRenderPath() + "prerender.json");
 
-  return directory.removeRecursively();
+  if (file.open(QIODevice::ReadOnly))
+    return QJsonDocument::fromJson(file.readAll()).object();
+  return QJsonObject();
 }
 
-void PreRenderComponent::preRenderAllTilemaps()
+void PreRenderComponent::saveManifest(const QJsonObject& manifest) const
 {
-  unsigned int i = 0;
+  QFile file(getPreRenderPath() + "prerender.json");
 
-  for (LevelGrid* grid : getFloors())
-  {
-    preRenderTilemap(grid->getTilemap(), "floor" + QString::number(i));
-    ++i;
-  }
+  if (file.open(QIODevice::WriteOnly))
+    file.write(QJsonDocument(manifest).toJson());
+  else
+    qDebug() << "PreRenderComponent: cannot write the prerender manifest";
 }
 
-void PreRenderComponent::preRenderTilemap(TileMap* tilemap, const QString& prefix)
+// Jobs run on a dedicated pool. They read the tile layers, which events could
+// modify: the GUI thread blocks until they are done instead of pumping events.
+void PreRenderComponent::runJobs(const QVector<PreRenderJob>& jobs)
 {
-  QDir dir;
+  QThreadPool pool;
 
-  dir.mkpath(getPreRenderPath());
-  preRenderGround(tilemap, prefix);
-  preRenderLayers(tilemap->getRoofs(), prefix + "_roof");
-  preRenderLayers(tilemap->getLights(), prefix + "_lights");
+  qDebug() << "PreRenderComponent: rendering" << jobs.size() << "outdated layers";
+  for (const PreRenderJob& job : jobs)
+    pool.start(job.render);
+  pool.waitForDone();
 }
 
-void PreRenderComponent::preRenderGround(TileMap* tilemap, const QString& prefix)
+void PreRenderComponent::collectTilemapJobs(TileMap* tilemap, const QString& prefix, QVector<PreRenderJob>& jobs)
 {
-  QString     tilemapFile = getPreRenderPath() + prefix + "_tilemap.png";
-  TileLayer*  ground = tilemap->getLayer("ground");
-  QImage      image(ground->getRenderedRect().size(), QImage::Format_ARGB32);
-  QPoint      offset(ground->getRenderedRect().x(), 0);
-  QStringList nonRenderable({"misc", "walls-v", "walls-h", "blocks", "ground"});
-  const auto& layers = tilemap->getLayers();
-
-  image.fill(Qt::transparent);
-  ground->renderToImage(image, offset);
-  for (auto it = layers.rbegin() ; it != layers.rend() ; ++it)
+  collectGroundJob(tilemap, prefix, jobs);
+  collectLayerJobs(tilemap->getRoofs(), prefix + "_roof", jobs);
+  collectLayerJobs(tilemap->getLights(), prefix + "_lights", jobs);
+}
+
+void PreRenderComponent::collectGroundJob(TileMap* tilemap, const QString& prefix, QVector<PreRenderJob>& jobs)
+{
+  TileLayer*          ground = tilemap->getLayer("ground");
+  QStringList         nonRenderable({"misc", "walls-v", "walls-h", "blocks", "ground"});
+  const auto&         tilemapLayers = tilemap->getLayers();
+  QVector<TileLayer*> layers;
+  QCryptographicHash  hash(QCryptographicHash::Sha1);
+  QRect               renderedRect;
+
+  if (!ground)
+    return ;
+  layers << ground;
+  for (auto it = tilemapLayers.rbegin() ; it != tilemapLayers.rend() ; ++it)
   {
     TileLayer* layer = *it;
 
     if (layer->isVisible() && !nonRenderable.contains(layer->getName()))
-      layer->renderToImage(image, offset);
+      layers << layer;
+  }
+  for (TileLayer* layer : qAsConst(layers))
+    hash.addData(layer->getContentHash());
+  renderedRect = ground->getRenderedRect();
+  jobs.push_back(PreRenderJob{
+    prefix + "_tilemap",
+    getPreRenderPath() + prefix + "_tilemap.json",
+    hash.result(),
+    std::bind(&PreRenderComponent::preRenderGround, this, layers, renderedRect, prefix)
+  });
+}
+
+void PreRenderComponent::collectLayerJobs(const QList<TileLayer*>& layers, const QString &prefix, QVector<PreRenderJob>& jobs)
+{
+  for (TileLayer* layer : layers)
+  {
+    QString fileName = getPreRenderPath() + prefix + '_' + layer->getName() + ".png";
+    QRect   renderedRect;
+
+    // light sources are drawn at runtime
+    if (qobject_cast<LightLayer*>(layer))
+      continue ;
+    renderedRect = layer->getRenderedRect();
+    jobs.push_back(PreRenderJob{
+      prefix + '_' + layer->getName(),
+      fileName,
+      layer->getContentHash(),
+      [layer, renderedRect, fileName]()
+      {
+        QImage image(renderedRect.size(), QImage::Format_ARGB32);
+
+        image.fill(Qt::transparent);
+        layer->renderToImage(image, QPoint(renderedRect.x(), 0));
+        image.save(fileName);
+      }
+    });
   }
-  image.save(tilemapFile);
-  ground->setProperty("prerendered", true);
 }
 
-void PreRenderComponent::preRenderLayers(const QList<TileLayer*>& layers, const QString &prefix)
+static bool isTransparent(const QImage& image)
 {
-  for (TileLayer* lightLayer : layers)
+  for (int y = 0 ; y < image.height() ; ++y)
   {
-    QString fileName = prefix + '_' + lightLayer->getName() + ".png";
+    const QRgb* line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+
+    for (int x = 0 ; x < image.width() ; ++x)
+    {
+      if (qAlpha(line[x]) != 0)
+        return false;
+    }
+  }
+  return true;
+}
 
-    lightLayer->renderToFile(getPreRenderPath() + fileName);
+// The ground is rendered and saved in chunks of chunkSize x chunkSize pixels, along
+// with an index listing the non-empty ones, so that views only load what they show.
+void PreRenderComponent::preRenderGround(const QVector<TileLayer*>& layers, QRect renderedRect, const QString& prefix) const
+{
+  QSize       renderedSize = renderedRect.size();
+  QPoint      offset(renderedRect.x(), 0);
+  QJsonArray  chunks;
+  QJsonObject index;
+
+  for (int chunkY = 0 ; chunkY < renderedSize.height() ; chunkY += chunkSize)
+  {
+    for (int chunkX = 0 ; chunkX < renderedSize.width() ; chunkX += chunkSize)
+    {
+      QRect   chunkRect = QRect(chunkX, chunkY, chunkSize, chunkSize).intersected(QRect(QPoint(0, 0), renderedSize));
+      QImage  image(chunkRect.size(), QImage::Format_ARGB32);
+      QPoint  chunkOffset = offset + chunkRect.topLeft();
+      QString fileName = prefix + "_tilemap_" + QString::number(chunkX / chunkSize) + '_' + QString::number(chunkY / chunkSize) + ".png";
+
+      image.fill(Qt::transparent);
+      for (TileLayer* layer : layers)
+        layer->renderToImage(image, chunkOffset);
+      if (isTransparent(image))
+        continue ;
+      image.save(getPreRenderPath() + fileName);
+      chunks << QJsonObject{
+        {"x", chunkRect.x()}, {"y", chunkRect.y()},
+        {"width", chunkRect.width()}, {"height", chunkRect.height()},
+        {"file", fileName}
+      };
+    }
   }
+  index["width"]  = renderedSize.width();
+  index["height"] = renderedSize.height();
+  index["chunks"] = chunks;
+  saveChunkIndex(getPreRenderPath() + prefix + "_tilemap.json", index);
+}
+
+void PreRenderComponent::saveChunkIndex(const QString& path, const QJsonObject& index) const
+{
+  QFile file(path);
+
+  if (file.open(QIODevice::WriteOnly))
+    file.write(QJsonDocument(index).toJson(QJsonDocument::Compact));
+  else
+    qDebug() << "PreRenderComponent: cannot write" << path;
 }
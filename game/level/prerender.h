@@ -2,6 +2,7 @@
 # define PRERENDERCOMPONENT_H
 
 # include "zone.h"
+# include <functional>
 
 class PreRenderComponent : public ZoneComponent
 {
@@ -9,21 +10,37 @@ class PreRenderComponent : public ZoneComponent
   typedef ZoneComponent ParentType;
 
   Q_PROPERTY(QString preRenderPath READ getPreRenderPath CONSTANT)
+
+  // Renders one output of the cache. Jobs run on worker threads: anything that
+  // needs the GUI thread must be computed when the job is created.
+  struct PreRenderJob
+  {
+    QString               key;
+    QString               output;
+    QByteArray            hash;
+    std::function<void()> render;
+  };
 public:
+  static const int chunkSize = 1024;
+
   PreRenderComponent(QObject* parent = nullptr);
 
   void load(const QJsonObject&);
 
 protected:
+  // When false, every output gets rendered again on load
   virtual bool usePrerenderCache() const { return true; }
 
 private:
-  bool    clearCache() const;
-  void    preRenderAllTilemaps();
-  void    preRenderTilemap(TileMap*, const QString& prefix);
-  void    preRenderGround(TileMap*, const QString& prefix);
-  void    preRenderLayers(const QList<TileLayer*>&, const QString& prefix);
-  QString getPreRenderPath() const;
+  QJsonObject loadManifest() const;
+  void        saveManifest(const QJsonObject&) const;
+  void        runJobs(const QVector<PreRenderJob>&);
+  void        collectTilemapJobs(TileMap*, const QString& prefix, QVector<PreRenderJob>&);
+  void        collectGroundJob(TileMap*, const QString& prefix, QVector<PreRenderJob>&);
+  void        collectLayerJobs(const QList<TileLayer*>&, const QString& prefix, QVector<PreRenderJob>&);
+  void        preRenderGround(const QVector<TileLayer*>& layers, QRect renderedRect, const QString& prefix) const;
+  void        saveChunkIndex(const QString& path, const QJsonObject&) const;
+  QString     getPreRenderPath() const;
 };
 
 #endif // PRERENDERCOMPONENT_H
@@ -0,0 +1,124 @@
+#include "prerenderchunks.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QDebug>
+#include <algorithm>
+
+PreRenderChunkModel::PreRenderChunkModel(QObject* parent) : QAbstractListModel(parent)
+{
+}
+
+void PreRenderChunkModel::setIndexFile(const QString& value)
+{
+  if (indexFile != value)
+  {
+    indexFile = value;
+    beginResetModel();
+    loadIndex();
+    visibleChunks.clear();
+    endResetModel();
+    emit indexFileChanged();
+    refreshVisibleChunks();
+  }
+}
+
+void PreRenderChunkModel::setViewport(QRect value)
+{
+  if (viewport != value)
+  {
+    viewport = value;
+    emit viewportChanged();
+    refreshVisibleChunks();
+  }
+}
+
+void PreRenderChunkModel::loadIndex()
+{
+  QFile file(indexFile);
+
+  chunks.clear();
+  size = QSize();
+  if (file.open(QIODevice::ReadOnly))
+  {
+    QJsonObject index     = QJsonDocument::fromJson(file.readAll()).object();
+    QString     directory = QFileInfo(indexFile).absolutePath() + '/';
+
+    size = QSize(index["width"].toInt(), index["height"].toInt());
+    for (const QJsonValue& value : index["chunks"].toArray())
+    {
+      QJsonObject chunk = value.toObject();
+
+      chunks.push_back(Chunk{
+        QRect(chunk["x"].toInt(), chunk["y"].toInt(), chunk["width"].toInt(), chunk["height"].toInt()),
+        directory + chunk["file"].toString()
+      });
+    }
+  }
+  else if (!indexFile.isEmpty())
+    qDebug() << "PreRenderChunkModel: cannot open" << indexFile;
+}
+
+// Both lists are sorted by chunk index: rows leaving the viewport are removed first,
+// which leaves a subset of the new list in which the entering rows can be inserted.
+void PreRenderChunkModel::refreshVisibleChunks()
+{
+  QRect        area = viewport.adjusted(-prefetchMargin, -prefetchMargin, prefetchMargin, prefetchMargin);
+  QVector<int> nextChunks;
+
+  for (int i = 0 ; i < chunks.size() ; ++i)
+  {
+    if (chunks[i].rect.intersects(area))
+      nextChunks << i;
+  }
+  for (int row = visibleChunks.size() - 1 ; row >= 0 ; --row)
+  {
+    if (!std::binary_search(nextChunks.begin(), nextChunks.end(), visibleChunks[row]))
+    {
+      beginRemoveRows(QModelIndex(), row, row);
+      visibleChunks.remove(row);
+      endRemoveRows();
+    }
+  }
+  for (int row = 0 ; row < nextChunks.size() ; ++row)
+  {
+    if (row >= visibleChunks.size() || visibleChunks[row] != nextChunks[row])
+    {
+      beginInsertRows(QModelIndex(), row, row);
+      visibleChunks.insert(row, nextChunks[row]);
+      endInsertRows();
+    }
+  }
+}
+
+int PreRenderChunkModel::rowCount(const QModelIndex& parent) const
+{
+  return parent.isValid() ? 0 : visibleChunks.size();
+}
+
+QVariant PreRenderChunkModel::data(const QModelIndex& index, int role) const
+{
+  if (index.isValid() && index.row() < visibleChunks.size())
+  {
+    const Chunk& chunk = chunks.at(visibleChunks.at(index.row()));
+
+    switch (role)
+    {
+    case RectRole:
+      return chunk.rect;
+    case SourceRole:
+      return "image://prerender/" + chunk.file;
+    }
+  }
+  return QVariant();
+}
+
+QHash<int, QByteArray> PreRenderChunkModel::roleNames() const
+{
+  return {
+    {RectRole,   "chunkRect"},
+    {SourceRole, "source"}
+  };
+}
@@ -0,0 +1,60 @@
+#ifndef  PRERENDERCHUNKS_H
+# define PRERENDERCHUNKS_H
+
+# include <QAbstractListModel>
+# include <QRect>
+# include <QVector>
+
+// Lists the chunks of a prerendered ground that intersect the viewport.
+// Rows are inserted and removed as the viewport moves, so that the views
+// only keep the chunks the camera can see.
+class PreRenderChunkModel : public QAbstractListModel
+{
+  Q_OBJECT
+
+  Q_PROPERTY(QString indexFile READ getIndexFile WRITE setIndexFile NOTIFY indexFileChanged)
+  Q_PROPERTY(QRect   viewport  READ getViewport  WRITE setViewport  NOTIFY viewportChanged)
+  Q_PROPERTY(QSize   size      READ getSize                         NOTIFY indexFileChanged)
+
+  struct Chunk
+  {
+    QRect   rect;
+    QString file;
+  };
+public:
+  enum ChunkRole
+  {
+    RectRole = Qt::UserRole + 1,
+    SourceRole
+  };
+
+  static const int prefetchMargin = 256;
+
+  explicit PreRenderChunkModel(QObject* parent = nullptr);
+
+  const QString& getIndexFile() const { return indexFile; }
+  void           setIndexFile(const QString&);
+  QRect          getViewport() const { return viewport; }
+  void           setViewport(QRect);
+  QSize          getSize() const { return size; }
+
+  int                    rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant               data(const QModelIndex& index, int role) const override;
+  QHash<int, QByteArray> roleNames() const override;
+
+signals:
+  void indexFileChanged();
+  void viewportChanged();
+
+private:
+  void loadIndex();
+  void refreshVisibleChunks();
+
+  QString        indexFile;
+  QRect          viewport;
+  QSize          size;
+  QVector<Chunk> chunks;
+  QVector<int>   visibleChunks;
+};
+
+#endif // PRERENDERCHUNKS_H
@@ -0,0 +1,35 @@
+#include "prerenderimageprovider.h"
+#include <QMutexLocker>
+#include <QDebug>
+
+PreRenderImageProvider::PreRenderImageProvider() : QQuickImageProvider(QQuickImageProvider::Image, QQuickImageProvider::ForceAsynchronousImageLoading)
+{
+  decodedChunks.setMaxCost(cacheSize);
+}
+
+QImage PreRenderImageProvider::requestImage(const QString& id, QSize* size, const QSize&)
+{
+  QImage result;
+
+  {
+    QMutexLocker lock(&mutex);
+    QImage*      cached = decodedChunks.object(id);
+
+    if (cached)
+      result = *cached;
+  }
+  if (result.isNull())
+  {
+    if (!result.load(id))
+      qDebug() << "PreRenderImageProvider: cannot load" << id;
+    else
+    {
+      QMutexLocker lock(&mutex);
+
+      decodedChunks.insert(id, new QImage(result), static_cast<int>(result.sizeInBytes() / 1024));
+    }
+  }
+  if (size)
+    *size = result.size();
+  return result;
+}
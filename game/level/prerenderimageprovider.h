@@ -0,0 +1,24 @@
+#ifndef  PRERENDERIMAGEPROVIDER_H
+# define PRERENDERIMAGEPROVIDER_H
+
+# include <QQuickImageProvider>
+# include <QCache>
+# include <QMutex>
+
+// Decodes prerendered chunks off the GUI thread, and keeps the most recently
+// used ones around so that the camera can come back to them without a reload.
+class PreRenderImageProvider : public QQuickImageProvider
+{
+public:
+  static const int cacheSize = 96 * 1024; // in kilobytes
+
+  PreRenderImageProvider();
+
+  QImage requestImage(const QString& id, QSize* size, const QSize& requestedSize) override;
+
+private:
+  QMutex                  mutex;
+  QCache<QString, QImage> decodedChunks;
+};
+
+#endif // PRERENDERIMAGEPROVIDER_H
@@ -0,0 +1,52 @@
+#include "scheduler.h"
+#include <QElapsedTimer>
+
+void LevelScheduler::add(const QString& name, qint64 interval, qint64 budget, Callback callback)
+{
+  Subsystem subsystem;
+
+  subsystem.name     = name;
+  subsystem.interval = interval;
+  subsystem.budget   = budget;
+  subsystem.callback = callback;
+  subsystems.push_back(subsystem);
+}
+
+void LevelScheduler::advance(qint64 elapsed)
+{
+  for (int i = 0 ; i < subsystems.size() ; ++i)
+    runSteps(subsystems[i], elapsed);
+}
+
+void LevelScheduler::runSteps(Subsystem& subsystem, qint64 elapsed)
+{
+  QElapsedTimer timer;
+  int           steps = 0;
+
+  timer.start();
+  if (subsystem.interval <= 0)
+    subsystem.callback(elapsed);
+  else
+  {
+    subsystem.accumulator += elapsed;
+    while (subsystem.accumulator >= subsystem.interval)
+    {
+      if (steps >= maxCatchUpSteps || (steps > 0 && timer.elapsed() >= subsystem.budget))
+      {
+        subsystem.droppedTime += subsystem.accumulator - subsystem.accumulator % subsystem.interval;
+        subsystem.accumulator %= subsystem.interval;
+        break ;
+      }
+      subsystem.callback(subsystem.interval);
+      subsystem.accumulator -= subsystem.interval;
+      ++steps;
+    }
+  }
+  subsystem.lastDuration = timer.elapsed();
+}
+
+void LevelScheduler::reset()
+{
+  for (Subsystem& subsystem : subsystems)
+    subsystem.accumulator = 0;
+}
@@ -0,0 +1,44 @@
+#ifndef  LEVEL_SCHEDULER_H
+# define LEVEL_SCHEDULER_H
+
+# include <QString>
+# include <QVector>
+# include <functional>
+
+// Runs the level's subsystems at their own rates. Subsystems with an interval
+// advance in fixed steps: when a tick comes late, they catch up with several
+// steps, up to maxCatchUpSteps and as long as they stay within their budget.
+// The time they couldn't catch up with is dropped instead of carried over.
+// Subsystems without an interval run once per tick with the real elapsed time.
+class LevelScheduler
+{
+public:
+  typedef std::function<void(qint64)> Callback;
+
+  struct Subsystem
+  {
+    QString  name;
+    qint64   interval;
+    qint64   budget;
+    Callback callback;
+    qint64   accumulator  = 0;
+    qint64   lastDuration = 0;
+    qint64   droppedTime  = 0;
+  };
+
+  static const int maxCatchUpSteps = 4;
+
+  // interval and budget are in milliseconds
+  void add(const QString& name, qint64 interval, qint64 budget, Callback callback);
+  void advance(qint64 elapsed);
+  void reset();
+
+  const QVector<Subsystem>& getSubsystems() const { return subsystems; }
+
+private:
+  void runSteps(Subsystem&, qint64 elapsed);
+
+  QVector<Subsystem> subsystems;
+};
+
+#endif
@@ -0,0 +1,63 @@
+#include "simulationlod.h"
+#include "game/character.h"
+#include "game/characterparty.h"
+#include <cstdlib>
+#include <algorithm>
+
+static SimulationLod::Tier tierFor(DynamicObject* object, const Character* player, const CharacterParty* playerParty)
+{
+  QPoint offset = object->getPosition() - player->getPosition();
+  int    distance = std::max(std::abs(offset.x()), std::abs(offset.y()));
+
+  if (object == player || (object->isCharacter() && playerParty && playerParty->containsCharacter(reinterpret_cast<Character*>(object))))
+    return SimulationLod::Full;
+  if (object->getCurrentFloor() != player->getCurrentFloor())
+    return SimulationLod::Dormant;
+  if (distance <= SimulationLod::fullRange)
+    return SimulationLod::Full;
+  if (distance <= SimulationLod::reducedRange)
+    return SimulationLod::Reduced;
+  return SimulationLod::Dormant;
+}
+
+void SimulationLod::refresh(const QList<DynamicObject*>& objects, const Character* player, const CharacterParty* playerParty)
+{
+  for (DynamicObject* object : objects)
+  {
+    State& state = states[object];
+    Tier   tier  = tierFor(object, player, playerParty);
+
+    if (state.tier == Dormant && tier != Dormant)
+    {
+      object->updateTasks(state.pendingTime);
+      state.pendingTime = 0;
+    }
+    else if (state.tier != Dormant && tier == Dormant)
+      state.pendingTime = 0;
+    state.tier = tier;
+  }
+}
+
+// Returns true when the object must be updated on this step, with `elapsed` as its delta
+bool SimulationLod::advance(DynamicObject* object, qint64 delta, qint64& elapsed)
+{
+  State& state = states[object];
+
+  state.pendingTime += delta;
+  if (state.tier == Full || (state.tier == Reduced && state.pendingTime >= reducedInterval))
+  {
+    elapsed = state.pendingTime;
+    state.pendingTime = 0;
+    return true;
+  }
+  return false;
+}
+
+int SimulationLod::count(Tier tier) const
+{
+  int result = 0;
+
+  for (const State& state : states)
+    result += state.tier == tier ? 1 : 0;
+  return result;
+}
@@ -0,0 +1,42 @@
+#ifndef  LEVEL_SIMULATIONLOD_H
+# define LEVEL_SIMULATIONLOD_H
+
+# include <QHash>
+# include <QList>
+
+class DynamicObject;
+class Character;
+class CharacterParty;
+
+// Sorts objects in simulation tiers depending on how far they are from the player:
+// - Full: updated on every step,
+// - Reduced: updated every reducedInterval milliseconds, with the time elapsed meanwhile,
+// - Dormant: not updated at all. Objects on another floor than the player are always dormant.
+// Dormant objects only accumulate time. When they wake up, that time gets replayed
+// on their task runner in one go.
+class SimulationLod
+{
+public:
+  enum Tier { Full = 0, Reduced, Dormant };
+
+  static const int    fullRange       = 15;
+  static const int    reducedRange    = 35;
+  static const qint64 reducedInterval = 200;
+
+  void refresh(const QList<DynamicObject*>& objects, const Character* player, const CharacterParty* playerParty);
+  bool advance(DynamicObject* object, qint64 delta, qint64& elapsed);
+  Tier getTier(const DynamicObject* object) const { return states.value(object).tier; }
+  void remove(const DynamicObject* object) { states.remove(object); }
+  int  count(Tier) const;
+
+private:
+  struct State
+  {
+    Tier   tier = Full;
+    qint64 pendingTime = 0;
+  };
+
+  QHash<const DynamicObject*, State> states;
+};
+
+#endif
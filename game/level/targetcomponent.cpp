@@ -27,7 +27,7 @@ void TargetComponent::swapMouseMode()
       targetList.reset();
       break ;
     default:
-      targetList.findNearbyTargets(allDynamicObjects());
+      targetList.findNearbyTargets(getObjectIndex().findObjectsInRange(getPlayer()->getPoint(), InteractionTargetList::nearbyRange));
       break ;
   }
   ParentType::swapMouseMode();
@@ -0,0 +1,55 @@
+#include "timeslicer.h"
+#include "metrics.h"
+#include <QElapsedTimer>
+#include <QVector>
+#include <algorithm>
+
+struct TimeSliceEntry
+{
+  DynamicObject*       object;
+  TimeSlicer::Priority priority;
+  qint64               pendingTime;
+
+  bool operator<(const TimeSliceEntry& other) const
+  {
+    return priority != other.priority ? priority < other.priority : pendingTime > other.pendingTime;
+  }
+};
+
+TimeSlicer::TimeSlicer(PerformanceReport& report, const QString& name, qint64 budget) : report(report), name(name), budget(budget)
+{
+}
+
+void TimeSlicer::run(const QList<DynamicObject*>& objects, qint64 delta, PriorityFunction priorityFor, Task task)
+{
+  QVector<TimeSliceEntry> entries;
+  QElapsedTimer           timer;
+  qint64                  deferredTime = 0;
+  int                     deferredCount = 0;
+
+  entries.reserve(objects.size());
+  for (DynamicObject* object : objects)
+  {
+    qint64& pending = pendingTime[object];
+
+    pending += delta;
+    entries.push_back(TimeSliceEntry{object, priorityFor(object), pending});
+  }
+  std::stable_sort(entries.begin(), entries.end());
+  timer.start();
+  for (const TimeSliceEntry& entry : qAsConst(entries))
+  {
+    if (entry.priority != Critical && timer.elapsed() >= budget)
+    {
+      report.object(entry.object).deferred++;
+      deferredTime += entry.pendingTime;
+      deferredCount++;
+    }
+    else
+    {
+      pendingTime.remove(entry.object);
+      task(entry.object, entry.pendingTime);
+    }
+  }
+  report.addDeferredWork(name, deferredCount, deferredTime);
+}
@@ -0,0 +1,36 @@
+#ifndef  LEVEL_TIMESLICER_H
+# define LEVEL_TIMESLICER_H
+
+# include <QString>
+# include <QHash>
+# include <QList>
+# include <functional>
+
+class DynamicObject;
+struct PerformanceReport;
+
+// Runs a per-object task within a time budget. Critical objects always run;
+// the others run by priority, then by how long they've been waiting, until the
+// budget is spent. Deferred objects accumulate the time they missed and receive
+// all of it on their next run.
+class TimeSlicer
+{
+public:
+  enum Priority { Critical = 0, Nearby, Background };
+
+  typedef std::function<Priority(DynamicObject*)>     PriorityFunction;
+  typedef std::function<void(DynamicObject*, qint64)> Task;
+
+  TimeSlicer(PerformanceReport& report, const QString& name, qint64 budget);
+
+  void run(const QList<DynamicObject*>& objects, qint64 delta, PriorityFunction, Task);
+  void remove(const DynamicObject* object) { pendingTime.remove(object); }
+
+private:
+  PerformanceReport&                  report;
+  QString                             name;
+  qint64                              budget;
+  QHash<const DynamicObject*, qint64> pendingTime;
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include "visibilitymatrix.h"
+#include "grid.h"
+#include "game/character.h"
+#include <cmath>
+
+// Entries are invalidated case by case; only drop floors which grew too large
+void VisibilityMatrix::refresh()
+{
+  for (FloorMemo& memo : qualities)
+  {
+    if (memo.size() > maximumMemoSize)
+      memo.clear();
+  }
+}
+
+VisibilityMatrix::FloorMemo* VisibilityMatrix::getFloorMemo(unsigned char floor)
+{
+  if (floor >= level.getFloorCount())
+    return nullptr;
+  if (qualities.size() < static_cast<int>(level.getFloorCount()))
+    qualities.resize(static_cast<int>(level.getFloorCount()));
+  return &qualities[floor];
+}
+
+// Like the previous level-wide scan, the range ignores floors
+QList<Character*> VisibilityMatrix::getCharactersInRange(const Character& observer, float radius)
+{
+  QList<Character*> result;
+  Point             center = observer.getPoint();
+  int               range  = static_cast<int>(std::ceil(radius));
+
+  for (unsigned int floor = 0 ; floor < level.getFloorCount() ; ++floor)
+  {
+    center.z = static_cast<unsigned char>(floor);
+    for (DynamicObject* object : level.getObjectIndex().findObjectsInRange(center, range))
+    {
+      Character* character = reinterpret_cast<Character*>(object);
+
+      if (object->isCharacter() && character != &observer && character->getDistance(&observer) < radius)
+        result << character;
+    }
+  }
+  return result;
+}
+
+int VisibilityMatrix::getVisionQuality(Point from, Point to)
+{
+  LevelGrid* grid = from.z == to.z ? level.getFloorGrid(from.z) : nullptr;
+  FloorMemo* memo = grid ? getFloorMemo(from.z) : nullptr;
+
+  if (!memo)
+    return 0;
+
+  const int     width = grid->getSize().width();
+  const quint64 key   = (static_cast<quint64>(from.y * width + from.x) << 32) | static_cast<quint32>(to.y * width + to.x);
+  auto          it    = memo->constFind(key);
+  Memo          entry;
+
+  if (it != memo->constEnd() && it->revision >= grid->getSightRevision(QPoint(from.x, from.y), QPoint(to.x, to.y)))
+    return it->quality;
+  entry.quality  = grid->getVisionQuality(from.x, from.y, to.x, to.y);
+  entry.revision = grid->getSightRevision();
+  memo->insert(key, entry);
+  return entry.quality;
+}
+
+// Only the pairs missing from the memo, or outdated, are traced, in a single batch
+QVector<int> VisibilityMatrix::getVisionQualities(Point from, const QVector<QPoint>& targets)
+{
+  LevelGrid*      grid = level.getFloorGrid(from.z);
+  FloorMemo*      memo = grid ? getFloorMemo(from.z) : nullptr;
+  QVector<int>    results(targets.size(), 0);
+  QVector<int>    missingIndexes;
+  QVector<QPoint> missingTargets;
+
+  if (!memo)
+    return results;
+
+  const int     width   = grid->getSize().width();
+  const quint64 fromKey = static_cast<quint64>(from.y * width + from.x) << 32;
+  const QPoint  origin(from.x, from.y);
+
+  for (int i = 0 ; i < targets.size() ; ++i)
+  {
+    auto it = memo->constFind(fromKey | static_cast<quint32>(targets[i].y() * width + targets[i].x()));
+
+    if (it != memo->constEnd() && it->revision >= grid->getSightRevision(origin, targets[i]))
+      results[i] = it->quality;
+    else
+    {
+      missingIndexes << i;
+      missingTargets << targets[i];
+    }
+  }
+  if (missingTargets.size() > 0)
+  {
+    QVector<int> traced = grid->getVisionQualities(from, missingTargets);
+    Memo         entry;
+
+    entry.revision = grid->getSightRevision();
+    for (int i = 0 ; i < traced.size() ; ++i)
+    {
+      QPoint target = missingTargets[i];
+
+      results[missingIndexes[i]] = traced[i];
+      entry.quality = traced[i];
+      memo->insert(fromKey | static_cast<quint32>(target.y() * width + target.x()), entry);
+    }
+  }
+  return results;
+}
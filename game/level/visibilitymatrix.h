@@ -0,0 +1,43 @@
+#ifndef  VISIBILITYMATRIX_H
+# define VISIBILITYMATRIX_H
+
+# include <QHash>
+# include <QList>
+# include <QVector>
+# include "utils/point.h"
+
+class GridComponent;
+class Character;
+
+// Memoizes line of sight queries between cases, shared by every FieldOfView.
+// Each entry remembers the sight revision it was traced at, and is only traced
+// again once a case within the bounding box of its two positions has changed.
+class VisibilityMatrix
+{
+public:
+  VisibilityMatrix(GridComponent& level) : level(level) {}
+
+  void              refresh();
+  QList<Character*> getCharactersInRange(const Character&, float radius);
+  int               getVisionQuality(Point from, Point to);
+  QVector<int>      getVisionQualities(Point from, const QVector<QPoint>& targets);
+  bool              hasLineOfSight(Point from, Point to) { return getVisionQuality(from, to) > 0; }
+
+private:
+  struct Memo
+  {
+    int     quality;
+    quint32 revision;
+  };
+
+  typedef QHash<quint64, Memo> FloorMemo;
+
+  static const int maximumMemoSize = 65536;
+
+  FloorMemo* getFloorMemo(unsigned char floor);
+
+  GridComponent&     level;
+  QVector<FloorMemo> qualities;
+};
+
+#endif // VISIBILITYMATRIX_H
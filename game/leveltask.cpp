@@ -11,10 +11,18 @@
 #include "objects/objectfactory.h"
 #include "i18n.h"
 
-LevelTask::LevelTask(QObject *parent) : ParentType(parent)
+LevelTask::LevelTask(QObject *parent) : ParentType(parent),
+  perceptionSlicer(performanceMetrics, "perception", 4),
+  taskSlicer(performanceMetrics, "tasks", 6)
 {
   taskRunner = new TaskRunner(this);
-  updateTimer.setInterval(30);
+  scheduler.add("lod",          250,            2,  [this](qint64) { refreshSimulationLod(); });
+  scheduler.add("simulation",   simulationStep, 12, [this](qint64 delta) { simulationTask(delta); });
+  scheduler.add("perception",   100,            4,  [this](qint64 delta) { perceptionTask(delta); });
+  scheduler.add("presentation", 0,              0,  [this](qint64 delta) { presentationTask(delta); });
+  // Ticks match the simulation step, so that each one advances the simulation once
+  updateTimer.setInterval(simulationStep);
+  updateTimer.setTimerType(Qt::PreciseTimer);
   updateTimer.setSingleShot(false);
   connect(&updateTimer, &QTimer::timeout, this, &LevelTask::update);
   connect(this, &LevelTask::pausedChanged, this, &LevelTask::onPauseChanged);
@@ -53,8 +61,6 @@ void LevelTask::registerDynamicObject(DynamicObject* object)
       addCharacterObserver(character, connect(character, &Character::floorChanged, this, [this]() { setCurrentFloor(getPlayer()->getCurrentFloor()); }, Qt::QueuedConnection));
   }
 
-  connect(object, &DynamicObject::lightZoneAdded, getTileMap(), &TileMap::addLightLayer);
-  connect(object, &DynamicObject::lightZoneRemoved, getTileMap(), &TileMap::removeLightLayer);
   object->reloadLightzone();
 
   ParentType::registerDynamicObject(object);
@@ -73,9 +79,11 @@ void LevelTask::unregisterDynamicObject(DynamicObject* object)
     });
   }
 
+  perceptionSlicer.remove(object);
+  taskSlicer.remove(object);
+  simulationLod.remove(object);
   performanceMetrics.removeObject(object);
-  disconnect(object, &DynamicObject::lightZoneAdded, getTileMap(), &TileMap::addLightLayer);
-  disconnect(object, &DynamicObject::lightZoneRemoved, getTileMap(), &TileMap::removeLightLayer);
+  object->clearLightzone();
 
   ParentType::unregisterDynamicObject(object);
 }
@@ -114,6 +122,7 @@ void LevelTask::onPauseChanged()
   else
   {
     updateTimer.start();
+    scheduler.reset();
     clock.restart();
   }
 }
@@ -134,8 +143,17 @@ void LevelTask::updateRoofVisibility()
 
 void LevelTask::update()
 {
-  qint64 delta = clock.restart();
+  simulated = false;
+  Sprite::beginFrameBatch();
+  scheduler.advance(clock.restart());
+  endFrameBatch();
+  if (simulated)
+    emit updated();
+}
 
+void LevelTask::simulationTask(qint64 delta)
+{
+  simulated = true;
   if ((combat && isCharacterTurn(getPlayer())) || !combat)
   {
     bool koMode   = getPlayer()->isUnconscious();
@@ -144,8 +162,6 @@ void LevelTask::update()
     enableWaitingMode(koMode || busyMode);
   }
 
-  updateRoofVisibility();
-
   ParentType::update(delta);
   if (!combat)
     realTimeTask(delta);
@@ -160,29 +176,122 @@ void LevelTask::update()
     else
       endTurnTask(delta);
   }
+  getPathfinder().resolvePathRequests();
+}
+
+void LevelTask::perceptionTask(qint64 delta)
+{
+  if (!combat)
+  {
+    QList<DynamicObject*> characters;
+
+    for (DynamicObject* object : qAsConst(attachedObjects))
+    {
+      if (object->isCharacter() && reinterpret_cast<Character*>(object)->isAlive() && simulationLod.getTier(object) != SimulationLod::Dormant)
+        characters << object;
+    }
+    perceptionSlicer.run(characters, delta, updatePriorities(), [this](DynamicObject* object, qint64 elapsed)
+    {
+      if (attachedObjects.contains(object))
+      {
+        ObjectPerformanceClock clock(performanceMetrics.object(object));
+
+        reinterpret_cast<Character*>(object)->getFieldOfView()->update(elapsed);
+      }
+    });
+  }
+}
+
+// The player and its party never wait. Characters the player can see, or objects
+// close to the player, go before the rest of the level.
+TimeSlicer::PriorityFunction LevelTask::updatePriorities() const
+{
+  const Character*        player      = getPlayer();
+  const CharacterParty*   playerParty = Game::get()->getPlayerParty();
+  QSet<DynamicObject*>    nearby;
+  QList<Character*>       visible     = visibleCharacters;
+
+  for (DynamicObject* object : getObjectIndex().findObjectsInRange(player->getPoint(), InteractionTargetList::nearbyRange))
+    nearby.insert(object);
+
+  return [player, playerParty, nearby, visible](DynamicObject* object)
+  {
+    Character* asCharacter = reinterpret_cast<Character*>(object);
+
+    if (object == player || (object->isCharacter() && playerParty->containsCharacter(asCharacter)))
+      return TimeSlicer::Critical;
+    if (nearby.contains(object) || (object->isCharacter() && visible.contains(asCharacter)))
+      return TimeSlicer::Nearby;
+    return TimeSlicer::Background;
+  };
+}
+
+void LevelTask::refreshSimulationLod()
+{
+  if (!combat)
+  {
+    const auto objectList = attachedObjects;
+
+    simulationLod.refresh(objectList, getPlayer(), Game::get()->getPlayerParty());
+  }
+}
+
+void LevelTask::presentationTask(qint64 delta)
+{
+  updateRoofVisibility();
   updateVisualEffects(delta);
-  emit updated();
+}
+
+void LevelTask::collectMetrics()
+{
+  for (const LevelScheduler::Subsystem& subsystem : scheduler.getSubsystems())
+  {
+    performanceMetrics.setCounter("Scheduler: " + subsystem.name + " last tick (ms)", subsystem.lastDuration);
+    performanceMetrics.setCounter("Scheduler: " + subsystem.name + " dropped (ms)",   subsystem.droppedTime);
+  }
+  performanceMetrics.setCounter("Simulation: full",    simulationLod.count(SimulationLod::Full));
+  performanceMetrics.setCounter("Simulation: reduced", simulationLod.count(SimulationLod::Reduced));
+  performanceMetrics.setCounter("Simulation: dormant", simulationLod.count(SimulationLod::Dormant));
+  performanceMetrics.setCounter("Simulation: parallel compute (ms)", parallelUpdate.getLastComputeTime());
+  ParentType::collectMetrics();
 }
 
 void LevelTask::realTimeTask(qint64 delta)
 {
   const auto objectList   = attachedObjects;
   const auto objectGroups = allObjectGroups();
+  QList<DynamicObject*> awakeObjects;
+  QVector<ParallelUpdate::Job> updateJobs;
 
   timeManager->addElapsedMilliseconds(delta);
   for (DynamicObject* object : objectList)
   {
-    ObjectPerformanceClock clock(performanceMetrics.object(object));
-    Character* asCharacter = reinterpret_cast<Character*>(object);
+    qint64 elapsed;
 
-    object->update(delta);
-    object->updateTasks(delta);
-    if (object->isCharacter() && asCharacter->isAlive() && attachedObjects.contains(object))
+    if (simulationLod.getTier(object) != SimulationLod::Dormant)
+      awakeObjects << object;
+    if (simulationLod.advance(object, delta, elapsed))
+      updateJobs.push_back(ParallelUpdate::Job{object, elapsed});
+  }
+  parallelUpdate.compute(updateJobs);
+  for (const ParallelUpdate::Job& job : qAsConst(updateJobs))
+  {
+    ObjectPerformanceClock clock(performanceMetrics.object(job.object));
+
+    job.object->applyUpdate();
+  }
+  taskSlicer.run(awakeObjects, delta, updatePriorities(), [this](DynamicObject* object, qint64 elapsed)
+  {
+    if (attachedObjects.contains(object))
     {
-      asCharacter->getFieldOfView()->update(delta);
-      asCharacter->getActionQueue()->update();
+      ObjectPerformanceClock clock(performanceMetrics.object(object));
+      Character* asCharacter = reinterpret_cast<Character*>(object);
+
+      object->updateTasks(elapsed);
+      if (object->isCharacter() && asCharacter->isAlive() && attachedObjects.contains(object))
+        asCharacter->getActionQueue()->update();
     }
-  }
+  });
   for (ObjectGroup* group : objectGroups)
     group->getTaskManager()->update(delta);
   taskRunner->update(delta);
@@ -15,6 +15,10 @@
 # include "level/save.h"
 # include "level/tutorialcomponent.h"
 # include "level/metrics.h"
+# include "level/scheduler.h"
+# include "level/timeslicer.h"
+# include "level/simulationlod.h"
+# include "level/parallelupdate.h"
 
 class Doorway;
 class CharacterParty;
@@ -29,6 +33,8 @@ class LevelTask : public SaveComponent
   Q_PROPERTY(bool       paused  MEMBER paused NOTIFY pausedChanged)
   Q_PROPERTY(TutorialComponent* tutorial MEMBER tutorial NOTIFY tutorialChanged)
 public:  
+  static const int simulationStep = 20; // in milliseconds
+
   explicit LevelTask(QObject *parent = nullptr);
   virtual ~LevelTask() override;
 
@@ -67,15 +73,28 @@ private slots:
 private:
   void onCombatStateChanged() override;
   void updateRoofVisibility();
+  void simulationTask(qint64);
+  void perceptionTask(qint64);
+  void refreshSimulationLod();
+  void presentationTask(qint64);
   void combatTask(qint64);
   void endTurnTask(qint64);
   void realTimeTask(qint64);
+  TimeSlicer::PriorityFunction updatePriorities() const;
 
 protected:
+  void collectMetrics() override;
+
   QTimer         updateTimer;
   QElapsedTimer  clock;
+  LevelScheduler scheduler;
+  TimeSlicer     perceptionSlicer;
+  TimeSlicer     taskSlicer;
+  SimulationLod  simulationLod;
+  ParallelUpdate parallelUpdate;
   bool           paused = true;
   bool           initialized = false;
+  bool           simulated = false;
   qint64         finalizeTurnRemainingTime = 0;
 };
 
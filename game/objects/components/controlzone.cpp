@@ -98,7 +98,17 @@ void ControlZoneComponent::toggleZoneBlocked(bool value)
 void ControlZoneComponent::updateZoneBlock()
 {
   if (controlZone)
+  {
     controlZone->setAccessBlocked(zoneBlocked);
+    if (Game::get()->getLevel())
+    {
+      ZoneGrid&     pathfinder = Game::get()->getLevel()->getPathfinder();
+      unsigned char zoneFloor = static_cast<unsigned char>(controlZone->getFloor());
+
+      for (QPoint position : controlZone->getAbsolutePositions())
+        pathfinder.invalidateCase({position.x(), position.y(), zoneFloor});
+    }
+  }
 }
 
 void ControlZoneComponent::updateCover()
@@ -112,7 +122,10 @@ void ControlZoneComponent::updateCover()
       auto* gridCase = grid->getGridCase(position + controlZone->getOffset());
 
       if (gridCase)
+      {
         gridCase->cover = zoneBlocked ? static_cast<char>(getCoverValue()) : 0;
+        grid->updateSightPlane(*gridCase);
+      }
     }
   }
 }
@@ -1,11 +1,17 @@
 #include "lightsource.h"
-#include "tilemap/tilelayer.h"
+#include "tilemap/tilemap.h"
 #include "game.h"
 
 LightSourceComponent::LightSourceComponent(QObject *parent) : ParentType(parent)
 {
   connect(this, &LightSourceComponent::lightRadiusChanged, this, &LightSourceComponent::reloadLightzone);
   connect(this, &LightSourceComponent::positionChanged,    this, &LightSourceComponent::refreshLightzone);
+  connect(this, &LightSourceComponent::floorChanged,       this, &LightSourceComponent::refreshLightzone);
+}
+
+LightSourceComponent::~LightSourceComponent()
+{
+  clearLightzone();
 }
 
 void LightSourceComponent::load(const QJsonObject& data)
@@ -25,59 +31,39 @@ void LightSourceComponent::save(QJsonObject& data) const
 
 void LightSourceComponent::reloadLightzone()
 {
-  if (lightRadius == 0 && lightZone)
-  {
-    emit lightZoneRemoved(lightZone);
-    lightZone->deleteLater();
-    lightZone = nullptr;
-  }
-  else if (lightRadius > 0)
-  {
-    auto* level = Game::get()->getLevel();
-    auto* tilemap = level ? level->getTileMap() : nullptr;
-
-    if (!lightZone && tilemap)
-    {
-      lightZone = new TileLayer(this);
-      lightZone->initialize(tilemap->getSize());
-      lightZone->setProperty("offset", QPoint(0, 0));
-      emit lightZoneAdded(lightZone);
-    }
-    refreshLightzone();
-  }
+  if (lightRadius > 0)
+    stampLightzone();
+  else
+    clearLightzone();
 }
 
+// Moves only matter once the light has been stamped on a floor
 void LightSourceComponent::refreshLightzone()
+{
+  if (lightLayer)
+    stampLightzone();
+}
+
+void LightSourceComponent::stampLightzone()
 {
   auto* level = Game::get()->getLevel();
+  auto* grid  = level ? level->getFloorGrid(static_cast<unsigned char>(getCurrentFloor())) : nullptr;
 
-  if (level && lightZone)
+  if (grid)
   {
-    auto*  tilemap = level->getTileMap();
-    auto*  tileset = tilemap->getTileset("lights");
-    QPoint position = getPosition();
-    QRect  zone(position.x() - lightRadius, position.y() - lightRadius, lightRadius * 2 + 1, lightRadius * 2 + 1);
-
-    int bottomTid      = tileset->getFirstGid() + 5;
-    int bottomLeftTid  = tileset->getFirstGid() + 8;
-    int middleTid      = tileset->getFirstGid() + 4;
-    int bottomRightTid = tileset->getFirstGid() + 2;
-    int rightTid       = tileset->getFirstGid() + 1;
-    int topRightTid    = tileset->getFirstGid() + 0;
-    int topTid         = tileset->getFirstGid() + 3;
-    int leftTid        = tileset->getFirstGid() + 7;
-    int topLeftTid     = tileset->getFirstGid() + 6;
+    LightLayer* layer = grid->getTilemap()->getDynamicLights();
 
-    lightZone->clear();
-    lightZone->fill(QRect(zone.x() + 1, zone.y() + 1, zone.width() - 2, zone.height() - 2), tileset, middleTid);
-    lightZone->setTileIdAt(zone.x(), zone.y(), tileset, topRightTid);
-    lightZone->fill(QRect(zone.x() + 1, zone.y(), zone.width() - 2, 1), tileset, rightTid);
-    lightZone->setTileIdAt(zone.right(), zone.y(), tileset, bottomRightTid);
-    lightZone->fill(QRect(zone.x(), zone.y() + 1, 1, zone.height() - 2), tileset, topTid);
-    lightZone->setTileIdAt(zone.x(), zone.bottom(), tileset, topLeftTid);
-    lightZone->fill(QRect(zone.x() + 1, zone.y() + zone.height() - 1, zone.width() - 2, 1), tileset, leftTid);
-    lightZone->setTileIdAt(zone.right(), zone.bottom(), tileset, bottomLeftTid);
-    lightZone->fill(QRect(zone.x() + zone.width() - 1, zone.y() + 1, 1, zone.height() - 2), tileset, bottomTid);
-    emit lightZone->tilesChanged();
+    if (layer != lightLayer)
+      clearLightzone();
+    if (layer)
+      layer->setLight(this, getPosition(), lightRadius);
+    lightLayer = layer;
   }
 }
+
+void LightSourceComponent::clearLightzone()
+{
+  if (lightLayer)
+    lightLayer->removeLight(this);
+  lightLayer = nullptr;
+}
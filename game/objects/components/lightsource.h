@@ -2,8 +2,9 @@
 # define LIGHTSOURCECOMPONENT_H
 
 # include "detectable.h"
+# include <QPointer>
 
-class TileLayer;
+class LightLayer;
 
 class LightSourceComponent : public DetectableComponent
 {
@@ -13,26 +14,24 @@ class LightSourceComponent : public DetectableComponent
   Q_PROPERTY(int lightRadius MEMBER lightRadius NOTIFY lightRadiusChanged)
 public:
   explicit LightSourceComponent(QObject *parent = nullptr);
+  ~LightSourceComponent() override;
 
   void load(const QJsonObject&);
   void save(QJsonObject&) const;
 
-  TileLayer* getLightZone() const { return lightZone; }
-
 signals:
   void lightRadiusChanged();
-  void lightZoneRemoved(TileLayer*);
-  void lightZoneAdded(TileLayer*);
 
 public slots:
   void reloadLightzone();
   void refreshLightzone();
+  void clearLightzone();
 
 private:
-  void drawLightzone();
+  void stampLightzone();
 
-  int lightRadius = 0;
-  TileLayer* lightZone = nullptr;
+  int                  lightRadius = 0;
+  QPointer<LightLayer> lightLayer;
 };
 
 #endif // LIGHTSOURCECOMPONENT_H
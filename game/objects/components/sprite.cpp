@@ -2,11 +2,24 @@
 #include <cmath>
 #include <QDebug>
 
+int              Sprite::frameBatchDepth = 0;
+QVector<Sprite*> Sprite::batchedFrames;
+
 Sprite::Sprite(QObject *parent) : ParentType(parent)
 {
   movementSpeed = 100;
   connect(this, &Sprite::spriteChanged, this, &Sprite::spriteSourceChanged);
   connect(this, &Sprite::spriteChanged, this, &Sprite::clippedRectChanged);
+  if (AnimationLibrary::get())
+    connect(AnimationLibrary::get(), &AnimationLibrary::spriteSheetReady, this, &Sprite::onSpriteSheetReady);
+}
+
+Sprite::~Sprite()
+{
+  if (frameChanged)
+    batchedFrames.removeOne(this);
+  if (AnimationLibrary::get())
+    AnimationLibrary::get()->releaseImage(animation.source);
 }
 
 bool Sprite::isAnimated() const
@@ -15,26 +28,91 @@ bool Sprite::isAnimated() const
 }
 
 void Sprite::update(qint64 delta)
+{
+  computeUpdate(delta);
+  applyUpdate();
+}
+
+// Steps the animation and the movement interpolation. Only touches the sprite's
+// own state and never emits, so that sprites may be computed concurrently: what
+// happened is recorded, then signaled by applyUpdate on the main thread.
+void Sprite::computeUpdate(qint64 delta)
 {
   if (animation.repeat || isAnimated())
   {
     animationElapsedTime += delta;
-    if (animationElapsedTime > animation.frameInterval)
+    if (animationElapsedTime >= animation.frameInterval)
       runAnimation();
   }
   if (spritePosition != spriteMovementTarget)
     runMovement(delta);
 }
 
+void Sprite::applyUpdate()
+{
+  if (pendingFrame)
+  {
+    pendingFrame = false;
+    notifyFrameChanged();
+  }
+  if (pendingAnimationFinished)
+  {
+    pendingAnimationFinished = false;
+    emit animationFinished();
+  }
+  if (pendingMovement)
+  {
+    pendingMovement = false;
+    emit spritePositionChanged();
+  }
+  if (pendingMovementFinished)
+  {
+    pendingMovementFinished = false;
+    emit movementFinished(this);
+  }
+}
+
 void Sprite::setAnimation(const QString &animationName)
 {
-  auto* library = AnimationLibrary::get();
+  auto*   library = AnimationLibrary::get();
+  int     animationId;
+  QString previousSource = animation.source;
 
+  if (groupId < 0)
+  {
+    groupId = library->getGroupId(name);
+    shadow  = library->getAnimation(groupId, library->getAnimationId(groupId, "shadow"));
+  }
+  animationId = library->getAnimationId(groupId, animationName);
   animationElapsedTime = 0;
-  animation = library->getAnimation(name, animationName);
-  shadow = library->getAnimation(name, "shadow");
+  pendingFrame = pendingAnimationFinished = false;
+  animation = library->getAnimation(groupId, animationId);
+  if (animationId < 0)
+    animation.name = animationName;
+  if (animation.source != previousSource)
+  {
+    library->retainImage(animation.source);
+    library->releaseImage(previousSource);
+  }
   emit spriteSourceChanged();
   emit clippedRectChanged();
+  emit animationChanged();
+}
+
+// Swaps the placeholder source for the freshly rendered sprite sheet, without restarting the animation
+void Sprite::onSpriteSheetReady(const QString& group)
+{
+  if (group == name && groupId >= 0)
+  {
+    auto*   library = AnimationLibrary::get();
+    QString previousSource = animation.source;
+
+    animation.source = library->getAnimation(groupId, library->getAnimationId(groupId, animation.name)).source;
+    shadow.source    = library->getAnimation(groupId, library->getAnimationId(groupId, "shadow")).source;
+    library->retainImage(animation.source);
+    library->releaseImage(previousSource);
+    emit spriteSourceChanged();
+  }
 }
 
 bool Sprite::hasAnimation(const QString& animationName) const
@@ -42,37 +120,75 @@ bool Sprite::hasAnimation(const QString& animationName) const
   return AnimationLibrary::get()->hasAnimation(name, animationName);
 }
 
+// Consumes every frame covered by the elapsed time, so that objects updated at a
+// lower rate, such as reduced ones, still animate at the animation's own speed.
 void Sprite::runAnimation()
 {
-  auto width = animation.clippedRect.width();
+  qint64 steps = 1;
 
-  animationElapsedTime = 0;
-  animation.currentFrame++;
-  if (animation.currentFrame >= animation.frameCount)
+  if (animation.frameInterval > 0)
+  {
+    steps = animationElapsedTime / animation.frameInterval;
+    animationElapsedTime %= animation.frameInterval;
+  }
+  else
+    animationElapsedTime = 0;
+  if (animation.currentFrame + steps >= animation.frameCount)
   {
     if (animation.repeat)
+      animation.currentFrame = animation.frameCount > 0 ? static_cast<int>((animation.currentFrame + steps) % animation.frameCount) : 0;
+    else
     {
-      animation.currentFrame = 0;
-      animation.clippedRect.setX(animation.firstFramePosition.x());
-      animation.clippedRect.setWidth(width);
+      animation.currentFrame = animation.frameCount;
+      animationElapsedTime = 0;
+      pendingAnimationFinished = true;
+      return ;
     }
-    else
-      emit animationFinished();
   }
   else
+    animation.currentFrame += static_cast<int>(steps);
+  if (animation.currentFrame < animation.frames.size())
   {
-    auto movement = width * (animation.reverse ? -1 : 1);
+    animation.clippedRect = animation.frames.at(animation.currentFrame);
+    pendingFrame = true;
+  }
+}
 
-    animation.clippedRect.adjust(movement, 0, movement, 0);
+// Within a frame batch, sprites don't signal frame changes: the outermost batch
+// returns them once it ends, each sprite appearing once no matter how many frames
+// it went through.
+void Sprite::notifyFrameChanged()
+{
+  if (frameBatchDepth == 0)
+    emit clippedRectChanged();
+  else if (!frameChanged)
+  {
+    frameChanged = true;
+    batchedFrames << this;
   }
-  emit clippedRectChanged();
 }
 
-const QImage& Sprite::getImage() const
+void Sprite::beginFrameBatch()
+{
+  frameBatchDepth++;
+}
+
+QVector<Sprite*> Sprite::endFrameBatch()
 {
-  const QImage& image = AnimationLibrary::get()->getImage(animation.source);
+  QVector<Sprite*> sprites;
+
+  if (--frameBatchDepth == 0)
+  {
+    sprites.swap(batchedFrames);
+    for (Sprite* sprite : qAsConst(sprites))
+      sprite->frameChanged = false;
+  }
+  return sprites;
+}
 
-  return image;
+QImage Sprite::getImage() const
+{
+  return AnimationLibrary::get()->getImage(animation.source);
 }
 
 
@@ -109,9 +225,9 @@ void Sprite::runMovement(qint64 delta)
   else if (distY > distX) { movementSpeedX = movementSpeed * (static_cast<float>(distX) / static_cast<float>(distY)); }
   spritePosition.setX(axisMovement(spritePosition.x(), spriteMovementTarget.x(), static_cast<int>(movementSpeedX)));
   spritePosition.setY(axisMovement(spritePosition.y(), spriteMovementTarget.y(), static_cast<int>(movementSpeedY)));
-  emit spritePositionChanged();
+  pendingMovement = true;
   if (spritePosition == spriteMovementTarget)
-    emit movementFinished(this);
+    pendingMovementFinished = true;
 }
 
 void Sprite::load(const QJsonObject& data)
@@ -19,15 +19,18 @@ class Sprite : public ControlZoneComponent
   Q_PROPERTY(QRect   clippedRect    READ getClippedRect    NOTIFY clippedRectChanged)
 public:
   explicit Sprite(QObject *parent = nullptr);
+  ~Sprite() override;
 
   Q_INVOKABLE void update(qint64);
+  void computeUpdate(qint64);
+  void applyUpdate();
 
-  void    setSpriteName(const QString& value) { name = value; emit spriteGroupChanged(); }
+  void    setSpriteName(const QString& value) { name = value; groupId = -1; emit spriteGroupChanged(); }
   QString getSpriteName() const { return name; }
   Q_INVOKABLE virtual void setAnimation(const QString& animationName);
   Q_INVOKABLE QString getAnimation() const { return animation.name; }
   Q_INVOKABLE virtual bool hasAnimation(const QString& animationName) const;
-  const QImage& getImage() const;
+  QImage getImage() const;
   void moveToCoordinates(QPoint coordinates);
   Q_INVOKABLE void setRenderPosition(QPoint coordinates);
   bool isAnimated() const;
@@ -44,27 +47,43 @@ public:
   void load(const QJsonObject&);
   void save(QJsonObject&) const;
 
+  static void             beginFrameBatch();
+  static QVector<Sprite*> endFrameBatch();
+
 signals:
   void spriteChanged();
   void spriteGroupChanged();
   void spriteSourceChanged();
   void spritePositionChanged();
   void clippedRectChanged();
+  void animationChanged();
   void animationFinished();
   void movementFinished(Sprite*);
   void floatingChanged();
 
+private slots:
+  void onSpriteSheetReady(const QString& group);
+
 private:
   void runAnimation();
   void runMovement(qint64);
+  void notifyFrameChanged();
 
 private:
   QPoint          spritePosition, spriteMovementTarget;
   bool            floating = false;
   QString         name;
+  int             groupId = -1;
   SpriteAnimation shadow;
   SpriteAnimation animation;
   qint64          animationElapsedTime;
+  bool            frameChanged = false;
+  bool            pendingFrame = false;
+  bool            pendingAnimationFinished = false;
+  bool            pendingMovement = false;
+  bool            pendingMovementFinished = false;
+  static int              frameBatchDepth;
+  static QVector<Sprite*> batchedFrames;
 protected:
   float           movementSpeed;
 };
@@ -53,8 +53,8 @@ int Doorway::getCoverValue() const
 
 void Doorway::removeTileConnections()
 {
-  for (void* caseContent : qAsConst(tileConnections))
-    reinterpret_cast<LevelGrid::CaseConnection*>(caseContent)->doorway = nullptr;
+  for (LevelGrid::CaseConnection connection : qAsConst(tileConnections))
+    connection.setDoorway(nullptr);
   tileConnections.clear();
 }
 
@@ -87,11 +87,11 @@ void Doorway::updateTileConnections()
   for (const QPoint& target : getTileConnectionTargets(getOrientation()))
   {
     LevelGrid::CaseContent*    targetCase = grid->getGridCase(origin + target);
-    LevelGrid::CaseConnection* connection = targetCase ? targetCase->connectionWith(doorwayCase) : nullptr;
+    LevelGrid::CaseConnection  connection = targetCase ? targetCase->connectionWith(doorwayCase) : LevelGrid::CaseConnection();
 
-    if (connection)
+    if (connection.isValid())
     {
-      connection->doorway = this;
+      connection.setDoorway(this);
       tileConnections.push_back(connection);
     }
   }
@@ -99,6 +99,8 @@ void Doorway::updateTileConnections()
 
 void Doorway::updateAccessPath()
 {
+  if (Game::get()->getLevel())
+    Game::get()->getLevel()->getPathfinder().invalidateCase(getPoint());
   if (hasControlZone())
     toggleZoneBlocked(!opened);
   else
@@ -107,7 +109,10 @@ void Doorway::updateAccessPath()
     LevelGrid::CaseContent* doorwayCase = grid ? grid->getGridCase(getPosition()) : nullptr;
 
     if (doorwayCase)
+    {
       doorwayCase->cover = static_cast<char>(getCoverValue());
+      grid->updateSightPlane(*doorwayCase);
+    }
   }
 }
 
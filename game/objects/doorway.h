@@ -2,6 +2,7 @@
 # define DOORWAY_H
 
 # include "../dynamicobject.h"
+# include "../pathfinding/levelgrid.h"
 
 class Doorway : public DynamicObject
 {
@@ -59,7 +60,7 @@ private:
   QString   keyName;
   int       lockpickLevel;
   QString   openSound, closeSound, lockedSound;
-  QVector<void*> tileConnections;
+  QVector<LevelGrid::CaseConnection> tileConnections;
 };
 
 #endif // DOORWAY_H
@@ -6,22 +6,156 @@
 # define ASTAR_HPP
 
 //# include "globals.hpp"
-# include <list>
 # include <vector>
 # include <map>
 # include <algorithm>
-# include <iostream>
+# include <functional>
 # include <assert.h>
 
 /*
  * A bit of documentation so you don't have to read this gorgeous piece of code:
  * UserState must implements at least
- * Actor type definition                                          : a type for the reference to the object moving through the nodes
- * bool  operator==()                                             : comparaison between two references to a UserState
- * float GetCost(UserState, Actor*)                               : the cost to go from a UserState to the one passed as parameter, for a given Actor
- * float GoalDistanceEstimate(UserState)                          : Heuristic between a UserState and another oneç
- * std::list<UserState*> GetSuccessors(UserState* parent, Actor*) : All the possible successor to the UserState, considering the parent and the Actor
+ * Actor type definition                                 : a type for the reference to the object moving through the nodes
+ * unsigned int GetSearchKey()                           : a small integer uniquely identifying the UserState, used to index the search context
+ * float GetCost(UserState, Actor*)                      : the cost to go from a UserState to the one passed as parameter, for a given Actor
+ * float GoalDistanceEstimate(UserState)                 : Heuristic between a UserState and another one
+ * void  EachSuccessor(UserState* parent, Actor*, FUNC)  : calls FUNC(UserState*) for all the possible successors to the UserState,
+ *                                                         considering the parent and the Actor
+ *
+ * UserStates are never copied: the search works on pointers to the states owned by the caller.
  */
+
+/*
+ * Memory used by a search: it is meant to be kept around and shared by successive
+ * searches, so that once it has grown to the size of the map, searching doesn't
+ * allocate anymore.
+ * - nodes are stored in an arena that is emptied, but not freed, between searches,
+ * - the open list is a binary heap of node indexes, each node knowing its own position in the heap,
+ * - the UserState => node lookup is a table indexed by search keys, in which entries
+ *   are only valid when their stamp matches the current search generation.
+ */
+template<class UserState>
+class AstarSearchContext
+{
+public:
+  struct Node
+  {
+    UserState* state;
+    int        parent; // index of the node we came from, or -1 for the start node
+    int        heapIndex; // position in the open list, or -1 when the node isn't in it
+    float      g; // cost of this node + it's predecessors
+    float      h; // heuristic estimate of distance to goal
+    float      f; // sum of cumulative cost of predecessors and self and heuristic
+  };
+
+  void reset()
+  {
+    nodes.clear();
+    heap.clear();
+    if (++generation == 0)
+    {
+      std::fill(stamps.begin(), stamps.end(), 0);
+      generation = 1;
+    }
+  }
+
+  int find(unsigned int key) const
+  {
+    return key < stamps.size() && stamps[key] == generation ? slots[key] : -1;
+  }
+
+  int create(UserState* state, unsigned int key)
+  {
+    int index = static_cast<int>(nodes.size());
+
+    if (key >= stamps.size())
+    {
+      stamps.resize(key + 1, 0);
+      slots.resize(key + 1, -1);
+    }
+    stamps[key] = generation;
+    slots[key]  = index;
+    nodes.push_back(Node{state, -1, -1, 0.f, 0.f, 0.f});
+    return index;
+  }
+
+  bool empty() const { return heap.empty(); }
+
+  void push(int index)
+  {
+    heap.push_back(index);
+    nodes[index].heapIndex = static_cast<int>(heap.size() - 1);
+    siftUp(heap.size() - 1);
+  }
+
+  int pop()
+  {
+    int index = heap.front();
+
+    place(0, heap.back());
+    heap.pop_back();
+    if (!heap.empty())
+      siftDown(0);
+    nodes[index].heapIndex = -1;
+    return index;
+  }
+
+  // Must be called after lowering the f value of a node that is in the open list
+  void update(int index)
+  {
+    siftUp(static_cast<size_t>(nodes[index].heapIndex));
+  }
+
+  std::vector<Node> nodes;
+
+private:
+  void place(size_t position, int index)
+  {
+    heap[position] = index;
+    nodes[index].heapIndex = static_cast<int>(position);
+  }
+
+  void siftUp(size_t position)
+  {
+    int index = heap[position];
+
+    while (position > 0)
+    {
+      size_t parent = (position - 1) / 2;
+
+      if (nodes[heap[parent]].f <= nodes[index].f)
+        break ;
+      place(position, heap[parent]);
+      position = parent;
+    }
+    place(position, index);
+  }
+
+  void siftDown(size_t position)
+  {
+    int    index = heap[position];
+    size_t count = heap.size();
+
+    while (position * 2 + 1 < count)
+    {
+      size_t child = position * 2 + 1;
+
+      if (child + 1 < count && nodes[heap[child + 1]].f < nodes[heap[child]].f)
+        child++;
+      if (nodes[index].f <= nodes[heap[child]].f)
+        break ;
+      place(position, heap[child]);
+      position = child;
+    }
+    place(position, index);
+  }
+
+  std::vector<int>          heap;
+  std::vector<unsigned int> stamps;
+  std::vector<int>          slots;
+  unsigned int              generation = 0;
+};
+
 template <class UserState>
 class AstarPathfinding
 {
@@ -37,43 +171,19 @@ public:
   // A lambda defining the limits of the search
   std::function<bool (const UserState&)> scope;
 
-  // A node represents a possible state in the search
-  // The user provided state type is included inside this type
-  struct Node
-  {
-    Node() : parent(0), child(0), g(0.f), h(0.f), f(0.f) {}
-
-    Node*     parent; // used during the search to record the parent of successor nodes
-    Node*     child; // used after the search for the application to view the search in reverse
-    float     g; // cost of this node + it's predecessors
-    float     h; // heuristic estimate of distance to goal
-    float     f; // sum of cumulative cost of predecessors and self and heuristic
-    UserState userNode;
-  };
-  typedef std::vector<Node*>                    NodeList;
-  typedef typename std::vector<Node*>::iterator NodeListIterator;
-  typedef std::list<UserState>                  Solution;
-  typedef std::list<UserState>                  CandidateList;
-  typedef std::map<UserState, Solution>         SolutionList;
-
-  struct FunctorCompareNode
-  {
-    bool operator() ( const Node *x, const Node *y ) const { return (x->f > y->f); }
-  };
+  typedef AstarSearchContext<UserState>      Context;
+  typedef typename Context::Node             Node;
+  typedef std::vector<UserState*>            Solution;
+  typedef std::vector<UserState*>            CandidateList;
+  typedef std::map<unsigned int, Solution>   SolutionList;
 
-  AstarPathfinding(typename UserState::Actor* actor = nullptr) : _state(NotInitialized), _cancelRequest(false), _acceptAnyCandidate(false)
+  AstarPathfinding(typename UserState::Actor* actor = nullptr, Context* context = nullptr) : _state(NotInitialized), _cancelRequest(false), _acceptAnyCandidate(false)
   {
-    _actor          = actor;
-    _allocateNodeIt = 0;
-    _start          = 0;
-    _goal           = 0;
-  }
-
-  ~AstarPathfinding()
-  {
-    if (_state == Succeeded)
-      FreeSolutionNodes();
-    FreeAllNodes();
+    _actor   = actor;
+    _context = context ? context : &_ownContext;
+    _goal    = nullptr;
+    _goalKey = 0;
+    _nSteps  = 0;
   }
 
   void CancelSearch(void)
@@ -89,89 +199,38 @@ public:
   // Set Start and goal states
   void SetStartAndGoalStates(UserState& Start, const CandidateList& Candidates)
   {
-    FreeSolutionNodes();
+    assert(Candidates.size() > 0);
 
+    _context->reset();
+    _solution.clear();
+    _secondarySolutions.clear();
     _cancelRequest = false;
 
-    _start = new Node;
-    _goal  = new Node;
+    _goal    = Candidates.front();
+    _goalKey = _goal->GetSearchKey();
+    _secondaryGoals.clear();
+    for (auto it = ++Candidates.begin() ; it != Candidates.end() ; ++it)
+      _secondaryGoals.push_back((*it)->GetSearchKey());
 
-    assert(_start != NULL && _goal != NULL && Candidates.size() > 0);
+    int   index = _context->create(&Start, Start.GetSearchKey());
+    Node& start = _context->nodes[index];
 
-    _start->userNode = Start;
-    _goal->userNode  = *Candidates.begin();
-
-    std::copy(++Candidates.begin(), Candidates.end(), std::back_inserter(_secondaryGoals));
-
-    _state = Searching;
-
-    _start->g = 0;
-    _start->h = _start->userNode.GoalDistanceEstimate( _goal->userNode );
-    _start->f = _start->g + _start->h;
-    _start->parent = 0;
+    start.g = 0;
+    start.h = Start.GoalDistanceEstimate(*_goal);
+    start.f = start.g + start.h;
 
     // Push the start node on the Open list
-    _openList.push_back(_start);
-
-    // Sort back element into heap
-    std::push_heap( _openList.begin(), _openList.end(), FunctorCompareNode() );
+    _context->push(index);
 
-    // Initialise counter for search steps
+    _state  = Searching;
     _nSteps = 0;
   }
 
-  void  SearchSuccedded(Node* node)
-  {
-    _goal->parent = node->parent;
-
-    // A special case is that the goal was passed in as the start state
-    // so handle that here
-    if (!(node->userNode == _start->userNode))
-    {
-      // set the child pointers in each node (except Goal which has no child)
-      Node *nodeChild  = _goal;
-      Node *nodeParent = _goal->parent;
-
-      do
-      {
-        nodeParent->child = nodeChild;
-        nodeChild         = nodeParent;
-        nodeParent        = nodeParent->parent;
-      }
-      while(nodeChild != _start); // Start is always the first node by definition
-      delete node;
-    }
-    // delete nodes that aren't needed for the solution
-    FreeUnusedNodes();
-    _state = Succeeded;
-  }
-
-  void StoreSecondarySolution(Node* node)
-  {
-    typename SolutionList::iterator currentSecondarySolution = _secondarySolutions.find(node->userNode);
-    std::list<UserState> solution;
-    Node*                current = node;
-
-    while (current != _start)
-    {
-      solution.insert(solution.begin(), current->userNode);
-      current = current->parent;
-    }
-    solution.insert(solution.begin(), _start->userNode);
-    if (currentSecondarySolution == _secondarySolutions.end() || currentSecondarySolution->second.size() > solution.size())
-      _secondarySolutions.emplace(node->userNode, solution);
-  }
-
   Solution* GetBestSolution()
   {
     if (_state == Succeeded)
-    {
-      _secondarySolutions.emplace(_goal->userNode, GetSolution());
-      auto it = _secondarySolutions.find(_goal->userNode);
-      if (it != _secondarySolutions.end())
-        return &(it->second);
-    }
-    for (const UserState& candidate : _secondaryGoals)
+      return &_solution;
+    for (unsigned int candidate : _secondaryGoals)
     {
       typename SolutionList::iterator solution = _secondarySolutions.find(candidate);
 
@@ -183,227 +242,115 @@ public:
 
   State SearchStep()
   {
-    if (_openList.empty() || _cancelRequest || _state == NotInitialized)
+    if (_state == Succeeded || _state == Failed)
+      return _state;
+    if (_state == NotInitialized || _cancelRequest || _context->empty())
     {
-      FreeAllNodes();
       _state = Failed;
+      return _state;
     }
-    else if (_state != Succeeded && _state != Failed)
-    {
-      _nSteps++;
+    _nSteps++;
 
-      // Pop the best node (the one with the lowest f)
-      Node* node = _openList.front(); // get pointer to the node
-      std::pop_heap( _openList.begin(), _openList.end(), FunctorCompareNode() );
-      _openList.pop_back();
+    // Pop the best node (the one with the lowest f) and close it
+    int        current      = _context->pop();
+    UserState* currentState = _context->nodes[current].state;
+    float      currentG     = _context->nodes[current].g;
+    int        parent       = _context->nodes[current].parent;
+    unsigned int currentKey = currentState->GetSearchKey();
 
-      if (node->userNode == _goal->userNode)
-        SearchSuccedded(node);
-      else // not goal
-      {
-        std::list<UserState*> userSuccessors = node->userNode.GetSuccessors(node->parent ? &node->parent->userNode : 0, _actor);
-
-        typename std::list<UserState*>::iterator successorIt  = userSuccessors.begin();
-        typename std::list<UserState*>::iterator successorEnd = userSuccessors.end();
-
-        if (std::find(_secondaryGoals.begin(), _secondaryGoals.end(), node->userNode) != _secondaryGoals.end())
-        {
-          StoreSecondarySolution(node);
-          if (_acceptAnyCandidate)
-          {
-            CancelSearch();
-            return _state;
-          }
-        }
-
-        for (; successorIt != successorEnd; ++successorIt)
-        {
-          // Skip the successor unless it's part of the scope or goals
-          if (scope && !scope(**successorIt) && !(_goal->userNode == **successorIt))
-            continue ;
-
-          Node* successor = new Node();
-
-          successor->userNode = *(*successorIt);
-          //      The g value for this successor ...
-          float newg = node->g + node->userNode.GetCost(successor->userNode, _actor);
-
-          // Now we need to find whether the node is on the open or closed lists
-          // If it is but the node that is already on them is better (lower g)
-          // then we can forget about this successor
-
-          // First linear search of open list to find node
-
-          NodeListIterator closedListSearch;
-          NodeListIterator openListSearch;
-          NodeListIterator listEnd;
-
-          for(openListSearch = _openList.begin(), listEnd = _openList.end(); openListSearch != listEnd ; ++openListSearch)
-          {
-            if ((*openListSearch)->userNode == successor->userNode)
-              break ;
-          }
-          if (openListSearch != listEnd)        // we found this state on open
-          {
-            if ((*openListSearch)->g <= newg) // the one on Open is cheaper than this one
-            {
-              delete successor;
-              continue ;
-            }
-          }
-
-          for(closedListSearch = _closedList.begin(), listEnd = _closedList.end() ; closedListSearch != listEnd ; ++closedListSearch)
-          {
-            if ((*closedListSearch)->userNode == successor->userNode)
-              break;
-          }
-          if (closedListSearch != listEnd) // we found this state on closed
-          {
-            if( (*closedListSearch)->g <= newg ) // the one on Closed is cheaper than this one
-            {
-              delete successor;
-              continue;
-            }
-          }
-
-          // This node is the best node so far with this particular state
-          // so lets keep it and set up its AStar specific data ...
-
-          successor->parent = node;
-          successor->g = newg;
-          successor->h = successor->userNode.GoalDistanceEstimate( _goal->userNode );
-          successor->f = successor->g + successor->h;
-
-          // Remove successor from closed if it was on it
-
-          if(closedListSearch != _closedList.end() )
-          {
-            // remove it from Closed
-            delete (*closedListSearch);
-            _closedList.erase(closedListSearch);
-          }
-
-          // Update old version of this node
-          if(openListSearch != _openList.end())
-          {
-            delete (*openListSearch);
-            _openList.erase(openListSearch);
-            std::make_heap( _openList.begin(), _openList.end(), FunctorCompareNode() );
-          }
-
-          _openList.push_back(successor);                                        // heap now unsorted
-          std::push_heap( _openList.begin(), _openList.end(), FunctorCompareNode() ); // sort back element into heap
-        }
-        // push n onto Closed, as we have expanded it now
-        _closedList.push_back(node);
-      } // end else (not goal so expand)
+    if (currentKey == _goalKey)
+    {
+      BuildSolution(current, _solution);
+      _state = Succeeded;
+      return _state;
     }
-    return _state; // Succeeded bool is false at this point.
-  }
-
-  // Free the solution nodes
-  // This is done to clean up all used Node memory when you are done with the
-  // search
-  void FreeSolutionNodes()
-  {
-    Node *node = _start;
-
-    if(node && node->child)
+    if (std::find(_secondaryGoals.begin(), _secondaryGoals.end(), currentKey) != _secondaryGoals.end())
     {
-      do
+      StoreSecondarySolution(current, currentKey);
+      if (_acceptAnyCandidate)
       {
-        Node *del = node;
-        node = node->child;
-        delete del;
-
-      } while(node != _goal);
-      delete node;
+        CancelSearch();
+        return _state;
+      }
     }
-    else
+    currentState->EachSuccessor(parent >= 0 ? _context->nodes[parent].state : nullptr, _actor, [&](UserState* successor)
     {
-      if (_start) delete _start;
-      if (_goal)  delete _goal;
-    }
-    _start = 0;
-    _goal  = 0;
-  }
+      unsigned int key = successor->GetSearchKey();
 
-  std::list<UserState> GetSolution(void)
-  {
-    std::list<UserState> solution;
-    Node*                current = _start;
+      // Skip the successor unless it's part of the scope or goals
+      if (scope && !scope(*successor) && key != _goalKey)
+        return ;
 
-    while (current->child)
-    {
-      solution.push_back(current->userNode);
-      current = current->child;
-    }
-    solution.push_back(current->userNode);
-    return (solution);
+      float newg  = currentG + currentState->GetCost(*successor, _actor);
+      int   index = _context->find(key);
+
+      if (index >= 0)
+      {
+        Node& known = _context->nodes[index];
+
+        // the node was already reached with a cheaper path
+        if (known.g <= newg)
+          return ;
+        known.parent = current;
+        known.g      = newg;
+        known.f      = known.g + known.h;
+        if (known.heapIndex >= 0)
+          _context->update(index);
+        else
+          _context->push(index);
+      }
+      else
+      {
+        index = _context->create(successor, key);
+
+        Node& node = _context->nodes[index];
+
+        node.parent = current;
+        node.g      = newg;
+        node.h      = successor->GoalDistanceEstimate(*_goal);
+        node.f      = node.g + node.h;
+        _context->push(index);
+      }
+    });
+    return _state;
   }
 
   int GetStepCount() { return _nSteps; }
 
 private:
-  // This is called when a search fails or is cancelled to free all used memory
-  void FreeAllNodes()
+  void BuildSolution(int index, Solution& solution) const
   {
-    FreeUnusedNodes(false);
-    delete _goal;
-    _goal = 0;
-  }
-
-  // This call is made by the search class when the search ends. A lot of nodes may be
-  // created that are still present when the search ends. They will be deleted by this
-  // routine once the search ends
-  void FreeUnusedNodes(bool onlyUnused = true)
-  {
-    NodeListIterator it;
-    NodeListIterator end;
-
-    for (it = _openList.begin(), end = _openList.end() ; it != end ; ++it)
-    {
-      Node* node = *it;
-
-      if (!onlyUnused || !node->child)
-        delete node;
-    }
-    for (it = _closedList.begin(), end = _closedList.end() ; it != end ; ++it)
-    {
-      Node* node = *it;
-
-      if (!onlyUnused || !node->child)
-        delete node;
-    }
-    _openList.clear();
-    _closedList.clear();
+    solution.clear();
+    for (int current = index ; current >= 0 ; current = _context->nodes[current].parent)
+      solution.push_back(_context->nodes[current].state);
+    std::reverse(solution.begin(), solution.end());
   }
 
-  inline Node* PedirNode(void)
-  {
-    _allocateNodeIt++;
-    return new Node();
-  }
-  
-  inline void ReleaseNode(Node* node)
+  void StoreSecondarySolution(int index, unsigned int key)
   {
-    delete node;
-    _allocateNodeIt--;
+    typename SolutionList::iterator currentSecondarySolution = _secondarySolutions.find(key);
+    Solution solution;
+
+    BuildSolution(index, solution);
+    if (currentSecondarySolution == _secondarySolutions.end())
+      _secondarySolutions.emplace(key, solution);
+    else if (currentSecondarySolution->second.size() > solution.size())
+      currentSecondarySolution->second = solution;
   }
 
-  NodeList _openList;
-  NodeList _closedList;
-  State    _state;
-  bool     _cancelRequest;
-  bool     _acceptAnyCandidate;
-  int      _nSteps;
+  Context*     _context;
+  Context      _ownContext;
+  State        _state;
+  bool         _cancelRequest;
+  bool         _acceptAnyCandidate;
+  int          _nSteps;
 
-  Node*         _start;
-  Node*         _goal;
-  CandidateList _secondaryGoals;
-  SolutionList  _secondarySolutions;
+  UserState*                _goal;
+  unsigned int              _goalKey;
+  std::vector<unsigned int> _secondaryGoals;
+  Solution                  _solution;
+  SolutionList              _secondarySolutions;
 
-  unsigned int _allocateNodeIt;
   typename UserState::Actor* _actor = nullptr;
 };
 
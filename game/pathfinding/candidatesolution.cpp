@@ -47,7 +47,7 @@ CasePathfinder::CandidateList CandidateSolutions::candidateList(PathZone* zone)
   for (auto it = begin() ; it != end() ; ++it)
   {
     if (it->zone->id == zone->id)
-      list.push_back(*(it->target));
+      list.push_back(it->target);
   }
   return list;
 }
@@ -164,6 +164,8 @@ int LevelGrid::getCoverValue(int x, int y) const
 
 void LevelGrid::setCaseOccupant(CaseContent& _case, DynamicObject* occupant)
 {
+  bool wasOccupied = _case.occupied;
+
   if (occupant && occupant->isBlockingPath())
   {
     _case.occupied = true;
@@ -174,6 +176,9 @@ void LevelGrid::setCaseOccupant(CaseContent& _case, DynamicObject* occupant)
     _case.occupied = false;
     _case.occupant = nullptr;
   }
+  updateSightPlane(_case);
+  if (wasOccupied != _case.occupied)
+    reinterpret_cast<GridComponent*>(parent())->getPathfinder().invalidateCase(_case.position);
 }
 
 DynamicObject* LevelGrid::getOccupant(int x, int y)
@@ -7,6 +7,7 @@
 #include <QMap>
 #include <QVector>
 #include <QPair>
+#include <QHash>
 #include "utils/point.h"
 
 class TileMap;
@@ -18,6 +19,7 @@ class Doorway;
 class LevelGrid : public QObject
 {
   Q_OBJECT
+  friend class PathfindingStore;
 public:
   enum CaseFlag
   {
@@ -27,60 +29,97 @@ public:
   };
   Q_ENUM(CaseFlag)
 
+  // Bits of the sight plane: cases with none of these can't affect line of sight
+  enum SightFlag
+  {
+    SightCover    = 1,
+    SightHWall    = 2,
+    SightVWall    = 4,
+    SightBlock    = 8,
+    SightOccupant = 16
+  };
+
   struct CaseConnection;
+  struct CaseLink;
 
   struct CaseContent
   {
     typedef CharacterMovement    Actor;
     char                         hcover = 0, vcover = 0, cover = 0;
-    bool                         hwall = false, vwall = false, block = false;
-    bool                         occupied = false;
+    bool                         hwall : 1, vwall : 1, block : 1;
+    bool                         occupied : 1;
+    bool                         hasLinks : 1;
+    unsigned char                neighbours = 0;
+    unsigned int                 pathZone = 0;
     DynamicObject*               occupant = nullptr;
+    LevelGrid*                   grid = nullptr;
     Point                        position;
-    std::vector<CaseConnection*> connections;
     QVector<TileZone*>           zones;
 
+    CaseContent() : hwall(false), vwall(false), block(false), occupied(false), hasLinks(false) {}
+
     bool  isBlocked() const;
     bool  isLinkedTo(QPoint) const;
+    bool  hasConnections() const { return neighbours != 0 || hasLinks; }
     bool  operator==(const CaseContent& other) const { return position == other.position; }
     bool  operator==(const CaseContent* other) const { return position == other->position; }
     bool  operator< (const CaseContent& other) const { return position < other.position; }
     float GetCost(const CaseContent&, const Actor*) const { return 1.f; }
     float GoalDistanceEstimate(const CaseContent&) const;
-    std::list<CaseContent*> GetSuccessors(const CaseContent* parent, Actor*) const;
+    unsigned int GetSearchKey() const;
+    template<typename FUNCTOR>
+    void EachSuccessor(const CaseContent* parent, Actor*, FUNCTOR callback) const;
 
+    template<typename FUNCTOR>
+    void eachConnection(FUNCTOR callback) const;
     void connectWith(CaseContent*);
     void disconnectFrom(CaseContent*);
     void clearConnections();
-    CaseConnection* connectionWith(const CaseContent*) const;
+    CaseConnection connectionWith(const CaseContent*) const;
     int apCostTo(const CaseContent*) const;
   };
 
+  // Connections are not stored: they are built on demand from a case's
+  // neighbour mask, and from the sparse link table for doorways and elevators.
   struct CaseConnection
   {
-    void connect(CaseContent*, CaseContent*);
-    void disconnect();
-    bool operator==(const CaseContent* value) const { return pair.first == value || pair.second == value; }
+    CaseConnection() {}
+    CaseConnection(const CaseContent* a, CaseContent* b, Doorway* d = nullptr) : from(a), to(b), doorway(d) {}
+
+    bool isValid() const { return to != nullptr; }
     int getCost() const;
-    bool canGoThrough(CharacterMovement* character);
-    bool goThrough(CharacterMovement* character);
-    CaseContent* getTargetFor(const CaseContent* value) const { return value && pair.first->position == value->position ? pair.second : pair.first; }
+    bool canGoThrough(CharacterMovement* character) const;
+    bool goThrough(CharacterMovement* character) const;
+    void setDoorway(Doorway*);
 
-    QPair<CaseContent*, CaseContent*> pair;
+    const CaseContent* from = nullptr;
+    CaseContent* to = nullptr;
     Doorway* doorway = nullptr;
   };
 
+  struct CaseLink
+  {
+    CaseContent* target  = nullptr;
+    Doorway*     doorway = nullptr;
+    bool         extra   = false; // the link isn't part of the neighbour mask (elevators)
+  };
+
+  typedef QVector<CaseLink> CaseLinks;
+
   explicit LevelGrid(QObject *parent = nullptr);
   ~LevelGrid() override;
 
   void initializeGrid(TileMap*);
   void initializePathfinding();
   bool hasPathfindingZones() const;
+  void setSearchKeyOffset(unsigned int value) { searchKeyOffset = value; }
+  unsigned int getCaseCount() const { return static_cast<unsigned int>(grid.size()); }
 
   Q_INVOKABLE inline QSize   getSize() const { return size; }
   Q_INVOKABLE bool           isOccupied(int x, int y) const;
   Q_INVOKABLE DynamicObject* getOccupant(int x, int y);
   Q_INVOKABLE int            getVisionQuality(int x, int y, int toX, int toY);
+  QVector<int>               getVisionQualities(QPoint from, const QVector<QPoint>& targets);
   Q_INVOKABLE int            getCaseFlags(int x, int y) const;
   Q_INVOKABLE int            getCoverValue(int x, int y) const;
   Q_INVOKABLE TileMap*       getTilemap() const { return tilemap; }
@@ -102,18 +141,104 @@ public:
   CaseContent* getGridCase(int x, int y);
   CaseContent* getGridCase(int x, int y, unsigned char z);
   QVector<TileZone*> getZonesAt(QPoint);
+  void initializeSightPlane();
+  void updateSightPlane(const CaseContent&);
+  quint32 getSightRevision() const { return sightRevision; }
+  quint32 getSightRevision(QPoint from, QPoint to) const;
+
+  static const int neighbourOffsets[8][2];
+  static const int sightChunkSize = 8;
+  static int neighbourDirection(int offsetX, int offsetY);
 
 private:
-  static void setCaseOccupant(CaseContent&, DynamicObject*);
+  void setCaseOccupant(CaseContent&, DynamicObject*);
   void updateObjectVisibility(DynamicObject* object);
   void updateZoneCases(TileZone*);
   void setZoneCases(TileZone*, QVector<QPoint>);
+  int  indexOf(const CaseContent& gridCase) const { return gridCase.position.y * size.width() + gridCase.position.x; }
+  CaseContent* neighbourOf(const CaseContent& gridCase, int direction);
+  CaseLink* findLink(const CaseContent& from, const CaseContent* to);
+  CaseLink& requireLink(CaseContent& from, CaseContent* to);
+  void      removeLink(CaseContent& from, const CaseContent* to);
+  void      setLinkDoorway(CaseContent& from, CaseContent* to, Doorway*);
 
   TileMap*             tilemap = nullptr;
   QSize                size;
   QVector<CaseContent> grid;
+  QVector<unsigned char> sightPlane;
+  QVector<quint32>     sightChunks; // last sight revision at which each chunk changed
+  int                  sightChunkColumns = 0;
+  quint32              sightRevision = 0;
+  QHash<int, CaseLinks> links;
+  unsigned int         searchKeyOffset = 0;
   QMap<TileZone*, QVector<CaseContent*>>   zoneCases;
   QMap<TileZone*, QMetaObject::Connection> zoneListener;
 };
 
+inline int LevelGrid::neighbourDirection(int offsetX, int offsetY)
+{
+  int index = (offsetY + 1) * 3 + (offsetX + 1);
+
+  if (offsetX < -1 || offsetX > 1 || offsetY < -1 || offsetY > 1 || index == 4)
+    return -1;
+  return index < 4 ? index : index - 1;
+}
+
+template<typename FUNCTOR>
+void LevelGrid::CaseContent::eachConnection(FUNCTOR callback) const
+{
+  const CaseLinks* caseLinks = nullptr;
+
+  if (hasLinks)
+  {
+    auto it = grid->links.constFind(grid->indexOf(*this));
+
+    if (it != grid->links.constEnd())
+      caseLinks = &(*it);
+  }
+
+  for (int direction = 0 ; direction < 8 ; ++direction)
+  {
+    if (neighbours & (1 << direction))
+    {
+      CaseConnection connection(this, grid->neighbourOf(*this, direction));
+
+      if (caseLinks)
+      {
+        for (const CaseLink& link : *caseLinks)
+        {
+          if (link.target == connection.to)
+            connection.doorway = link.doorway;
+        }
+      }
+      callback(connection);
+    }
+  }
+  if (caseLinks)
+  {
+    for (const CaseLink& link : *caseLinks)
+    {
+      if (link.extra)
+        callback(CaseConnection(this, link.target, link.doorway));
+    }
+  }
+}
+
+inline unsigned int LevelGrid::CaseContent::GetSearchKey() const
+{
+  return grid->searchKeyOffset + static_cast<unsigned int>(grid->indexOf(*this));
+}
+
+template<typename FUNCTOR>
+void LevelGrid::CaseContent::EachSuccessor(const CaseContent* parent, Actor* actor, FUNCTOR callback) const
+{
+  eachConnection([&](const CaseConnection& connection)
+  {
+    CaseContent* node = connection.to;
+
+    if ((!parent || node->position != parent->position) && !node->isBlocked() && connection.canGoThrough(actor))
+      callback(node);
+  });
+}
+
 #endif // LEVELGRID_H
@@ -2,6 +2,7 @@
 #include "tilemap/tilezone.h"
 #include "../objects/doorway.h"
 #include <cmath>
+#include <vector>
 
 bool LevelGrid::CaseContent::isBlocked() const
 {
@@ -17,122 +18,210 @@ bool LevelGrid::CaseContent::isBlocked() const
   return true;
 }
 
-bool LevelGrid::CaseContent::isLinkedTo(QPoint position) const
+const int LevelGrid::neighbourOffsets[8][2] = {
+  {-1, -1}, {0, -1}, {1, -1},
+  {-1,  0},          {1,  0},
+  {-1,  1}, {0,  1}, {1,  1}
+};
+
+LevelGrid::CaseContent* LevelGrid::neighbourOf(const CaseContent& gridCase, int direction)
+{
+  return getGridCase(gridCase.position.x + neighbourOffsets[direction][0],
+                     gridCase.position.y + neighbourOffsets[direction][1]);
+}
+
+LevelGrid::CaseLink* LevelGrid::findLink(const CaseContent& from, const CaseContent* to)
 {
-  auto iterator = std::find_if(connections.begin(), connections.end(), [this, position](const CaseConnection* connection) -> bool
+  if (from.hasLinks)
   {
-    auto* target = connection->getTargetFor(this);
+    auto it = links.find(indexOf(from));
 
-    return target->position == position && !target->isBlocked();
-  });
-  return iterator != connections.end();
+    if (it != links.end())
+    {
+      for (CaseLink& link : *it)
+      {
+        if (link.target == to)
+          return &link;
+      }
+    }
+  }
+  return nullptr;
 }
 
-LevelGrid::CaseConnection* LevelGrid::CaseContent::connectionWith(const CaseContent* other) const
+LevelGrid::CaseLink& LevelGrid::requireLink(CaseContent& from, CaseContent* to)
 {
-  auto iterator = std::find_if(connections.begin(), connections.end(), [this, other](const CaseConnection* connection) -> bool
+  CaseLink* link = findLink(from, to);
+
+  if (!link)
   {
-    return connection->getTargetFor(this) == other;
-  });
+    CaseLinks& caseLinks = links[indexOf(from)];
 
-  return iterator != connections.end() ? *iterator : nullptr;
+    caseLinks.push_back(CaseLink());
+    link = &caseLinks.last();
+    link->target = to;
+    from.hasLinks = true;
+  }
+  return *link;
 }
 
-int LevelGrid::CaseContent::apCostTo(const CaseContent* other) const
+void LevelGrid::removeLink(CaseContent& from, const CaseContent* to)
 {
-  auto* connection = connectionWith(other);
+  auto it = links.find(indexOf(from));
 
-  return other ? connection->getCost() : 0;
+  if (it != links.end())
+  {
+    for (auto linkIt = it->begin() ; linkIt != it->end() ; ++linkIt)
+    {
+      if (linkIt->target == to)
+      {
+        it->erase(linkIt);
+        break ;
+      }
+    }
+    if (it->isEmpty())
+    {
+      links.erase(it);
+      from.hasLinks = false;
+    }
+  }
 }
 
-void LevelGrid::CaseContent::connectWith(CaseContent* other)
+static int neighbourDirectionBetween(const LevelGrid::CaseContent& a, const LevelGrid::CaseContent& b)
 {
-  if (other)
+  if (a.grid == b.grid)
+    return LevelGrid::neighbourDirection(b.position.x - a.position.x, b.position.y - a.position.y);
+  return -1;
+}
+
+bool LevelGrid::CaseContent::isLinkedTo(QPoint target) const
+{
+  int  direction = LevelGrid::neighbourDirection(target.x() - position.x, target.y() - position.y);
+  bool result = false;
+
+  if (direction >= 0 && (neighbours & (1 << direction)))
   {
-    CaseConnection* connection = new CaseConnection;
+    auto* targetCase = grid->neighbourOf(*this, direction);
 
-    connection->connect(this, other);
+    return targetCase && !targetCase->isBlocked();
   }
+  eachConnection([target, &result](const CaseConnection& connection)
+  {
+    if (connection.to->position == target && !connection.to->isBlocked())
+      result = true;
+  });
+  return result;
 }
 
-void LevelGrid::CaseContent::disconnectFrom(CaseContent* other)
+LevelGrid::CaseConnection LevelGrid::CaseContent::connectionWith(const CaseContent* other) const
 {
-  for (auto* connection : connections)
+  if (other)
   {
-    if (connection->getTargetFor(this) == other)
-    {
-      connection->disconnect();
-      break ;
-    }
+    int  direction = neighbourDirectionBetween(*this, *other);
+    auto* link = grid->findLink(*this, other);
+
+    if ((direction >= 0 && (neighbours & (1 << direction))) || (link && link->extra))
+      return CaseConnection(this, link ? link->target : grid->neighbourOf(*this, direction), link ? link->doorway : nullptr);
   }
+  return CaseConnection();
 }
 
-void LevelGrid::CaseContent::clearConnections()
+int LevelGrid::CaseContent::apCostTo(const CaseContent* other) const
 {
-  while (connections.size())
-    (*connections.begin())->disconnect();
+  return other ? connectionWith(other).getCost() : 0;
 }
 
-void LevelGrid::CaseConnection::connect(CaseContent* a, CaseContent* b)
+void LevelGrid::CaseContent::connectWith(CaseContent* other)
 {
-  pair = {a, b};
-  a->disconnectFrom(b);
-  b->disconnectFrom(a);
-  a->connections.push_back(this);
-  b->connections.push_back(this);
+  if (other)
+  {
+    int direction = neighbourDirectionBetween(*this, *other);
+
+    if (direction >= 0)
+    {
+      neighbours        |= 1 << direction;
+      other->neighbours |= 1 << (7 - direction);
+    }
+    else
+    {
+      grid->requireLink(*this, other).extra = true;
+      other->grid->requireLink(*other, this).extra = true;
+    }
+  }
 }
 
-template<typename ARRAY, typename VALUE>
-void removeFrom(ARRAY& array, VALUE value)
+void LevelGrid::CaseContent::disconnectFrom(CaseContent* other)
 {
-  auto it = std::find(array.begin(), array.end(), value);
+  if (other)
+  {
+    int direction = neighbourDirectionBetween(*this, *other);
 
-  if (it != array.end())
-      array.erase(it);
+    if (direction >= 0)
+    {
+      neighbours        &= ~(1 << direction);
+      other->neighbours &= ~(1 << (7 - direction));
+    }
+    grid->removeLink(*this, other);
+    other->grid->removeLink(*other, this);
+  }
 }
 
-void LevelGrid::CaseConnection::disconnect()
+void LevelGrid::CaseContent::clearConnections()
 {
-  removeFrom(pair.first->connections, this);
-  removeFrom(pair.second->connections, this);
-  delete this;
+  std::vector<CaseContent*> targets;
+
+  eachConnection([&targets](const CaseConnection& connection) { targets.push_back(connection.to); });
+  for (auto* target : targets)
+    disconnectFrom(target);
 }
 
 int LevelGrid::CaseConnection::getCost() const
 {
   if (doorway && !doorway->property("opened").toBool())
     return 3;
-  if (pair.first->position.z != pair.second->position.z)
+  if (from && to && from->position.z != to->position.z)
     return 3;
   return 1;
 }
 
-bool LevelGrid::CaseConnection::canGoThrough(CharacterMovement* character)
+bool LevelGrid::CaseConnection::canGoThrough(CharacterMovement* character) const
 {
   if (doorway)
     return doorway->canGoThrough(reinterpret_cast<Character*>(character));
   return true;
 }
 
-bool LevelGrid::CaseConnection::goThrough(CharacterMovement* character)
+bool LevelGrid::CaseConnection::goThrough(CharacterMovement* character) const
 {
   if (doorway)
     return doorway->onGoThrough(reinterpret_cast<Character*>(character));
   return true;
 }
 
-std::list<LevelGrid::CaseContent*> LevelGrid::CaseContent::GetSuccessors(const CaseContent* parent, Actor* actor) const
+void LevelGrid::setLinkDoorway(CaseContent& source, CaseContent* target, Doorway* doorway)
 {
-  std::list<LevelGrid::CaseContent*> results;
-
-  for (auto* connection : connections)
+  if (doorway)
+    requireLink(source, target).doorway = doorway;
+  else
   {
-    CaseContent* node = connection->getTargetFor(this);
+    CaseLink* link = findLink(source, target);
+
+    if (link && link->extra)
+      link->doorway = nullptr;
+    else if (link)
+      removeLink(source, target);
+  }
+}
 
-    if ((!parent || node->position != parent->position) && !node->isBlocked() && connection->canGoThrough(actor))
-      results.push_back(node);
+void LevelGrid::CaseConnection::setDoorway(Doorway* value)
+{
+  CaseContent* source = from ? from->grid->getGridCase(from->position.x, from->position.y) : nullptr;
+
+  if (source && to)
+  {
+    doorway = value;
+    source->grid->setLinkDoorway(*source, to, value);
+    to->grid->setLinkDoorway(*to, source, value);
   }
-  return results;
 }
 
 float LevelGrid::CaseContent::GoalDistanceEstimate(const CaseContent& other) const
@@ -4,7 +4,7 @@
 
 static bool hasTile(const TileLayer& ground, const LevelGrid::CaseContent& caseContent)
 {
-  return ground.getTile(caseContent.position.x, caseContent.position.y);
+  return ground.isInside(caseContent.position.x, caseContent.position.y);
 }
 
 static bool isCaseAvailable(const TileLayer* ground, const LevelGrid::CaseContent* caseContent)
@@ -26,6 +26,7 @@ void LevelGrid::initializeGrid(TileMap* tilemap_)
   grid.resize(size.width() * size.height());
   eachCase(std::bind(&PrepareCaseFunctor::run, &functor, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
   initializePathfinding();
+  initializeSightPlane();
 }
 
 void LevelGrid::initializePathfinding()
@@ -33,12 +34,19 @@ void LevelGrid::initializePathfinding()
   auto* ground     = tilemap->getLayer("ground");
   auto isAvailable = std::bind(isCaseAvailable, ground, std::placeholders::_1);
 
+  links.clear();
+  for (auto& gridCase : grid)
+  {
+    gridCase.position.z = tilemap->getFloor();
+    gridCase.grid       = this;
+    gridCase.neighbours = 0;
+    gridCase.hasLinks   = false;
+    gridCase.pathZone   = 0;
+  }
   if (!ground)
     return ;
   for (auto& gridCase : grid)
   {
-    gridCase.position.z = tilemap->getFloor();
-    gridCase.clearConnections();
     if (!isAvailable(&gridCase))
       continue ;
 
@@ -0,0 +1,118 @@
+#include "pathcache.h"
+#include "zonegrid.h"
+
+bool PathCache::findRoute(unsigned int fromZone, unsigned int toZone, QVector<PathZone*>& route)
+{
+  auto it = routes.constFind({fromZone, toZone});
+
+  if (it != routes.constEnd())
+  {
+    for (unsigned int id : *it)
+      route << zoneGrid.getPathZoneById(id);
+    statistics.routeHits++;
+    return true;
+  }
+  statistics.routeMisses++;
+  return false;
+}
+
+// Routes are shared by every actor, so they're only stored when each step can be
+// crossed without going through a doorway, as doorways are not open to everyone.
+bool PathCache::isAvailableToAnyone(const PathZone* from, const PathZone* to) const
+{
+  const PathZone::Connections* exits = from->getExitsTowards(to);
+
+  if (exits)
+  {
+    for (const PathZone::Connection& exit : *exits)
+    {
+      LevelGrid::CaseConnection connection = exit.first->connectionWith(exit.second);
+
+      if (connection.isValid() && !connection.doorway)
+        return true;
+    }
+  }
+  return false;
+}
+
+void PathCache::storeRoute(const QVector<PathZone*>& route)
+{
+  QVector<unsigned int> ids;
+
+  for (int i = route.size() - 1 ; i >= 0 ; --i)
+  {
+    if (i < route.size() - 1 && !isAvailableToAnyone(route[i], route[i + 1]))
+      break ;
+    ids.prepend(route[i]->id);
+    if (ids.size() > 1)
+      routes.insert({ids.first(), ids.last()}, ids);
+  }
+}
+
+// The exit a segment goes through is the one closest to the final target, so segments
+// are only shared between requests heading for the same target case.
+bool PathCache::findSegment(unsigned int zone, const LevelGrid::CaseContent& entry, unsigned int targetZone, const LevelGrid::CaseContent& goal, QList<Point>& path)
+{
+  auto zoneIt = segments.find({zone, targetZone});
+
+  if (zoneIt != segments.end())
+  {
+    auto it = zoneIt->find(SegmentKey(entry.GetSearchKey(), goal.GetSearchKey()));
+
+    if (it != zoneIt->end())
+    {
+      if (isValid(*it))
+      {
+        path << it->path;
+        statistics.segmentHits++;
+        return true;
+      }
+      zoneIt->erase(it);
+    }
+  }
+  statistics.segmentMisses++;
+  return false;
+}
+
+void PathCache::storeSegment(unsigned int zone, const LevelGrid::CaseContent& entry, unsigned int targetZone, const LevelGrid::CaseContent& goal, const QList<Point>& path)
+{
+  Segment                       segment;
+  const LevelGrid::CaseContent* previous = &entry;
+
+  segment.path = path;
+  for (const Point& position : path)
+  {
+    const LevelGrid::CaseContent* gridCase = zoneGrid.getGridCase(position);
+    const PathZone*               pathZone = gridCase ? zoneGrid.getPathZoneById(gridCase->pathZone) : nullptr;
+
+    if (!gridCase || !pathZone || previous->connectionWith(gridCase).doorway)
+      return ;
+    if (std::find(segment.revisions.begin(), segment.revisions.end(), ZoneRevision(pathZone->id, pathZone->revision)) == segment.revisions.end())
+      segment.revisions << ZoneRevision(pathZone->id, pathZone->revision);
+    previous = gridCase;
+  }
+  if (const PathZone* entryZone = zoneGrid.getPathZoneById(entry.pathZone))
+  {
+    if (std::find(segment.revisions.begin(), segment.revisions.end(), ZoneRevision(entryZone->id, entryZone->revision)) == segment.revisions.end())
+      segment.revisions << ZoneRevision(entryZone->id, entryZone->revision);
+  }
+  segments[{zone, targetZone}].insert(SegmentKey(entry.GetSearchKey(), goal.GetSearchKey()), segment);
+}
+
+bool PathCache::isValid(const Segment& segment) const
+{
+  for (const ZoneRevision& revision : segment.revisions)
+  {
+    const PathZone* pathZone = zoneGrid.getPathZoneById(revision.first);
+
+    if (!pathZone || pathZone->revision != revision.second)
+      return false;
+  }
+  return true;
+}
+
+void PathCache::clear()
+{
+  routes.clear();
+  segments.clear();
+}
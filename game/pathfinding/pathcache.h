@@ -0,0 +1,52 @@
+#ifndef  PATHCACHE_H
+# define PATHCACHE_H
+
+# include <QHash>
+# include <QPair>
+# include <QVector>
+# include <QList>
+# include "utils/point.h"
+# include "levelgrid.h"
+
+class ZoneGrid;
+struct PathZone;
+
+class PathCache
+{
+public:
+  typedef QPair<unsigned int, unsigned int> ZonePair;
+  typedef QPair<unsigned int, unsigned int> ZoneRevision;
+  typedef QPair<unsigned int, unsigned int> SegmentKey; // entry case, final target case
+
+  struct Statistics
+  {
+    unsigned int routeHits = 0, routeMisses = 0;
+    unsigned int segmentHits = 0, segmentMisses = 0;
+  };
+
+  PathCache(ZoneGrid& zoneGrid) : zoneGrid(zoneGrid) {}
+
+  bool findRoute(unsigned int fromZone, unsigned int toZone, QVector<PathZone*>& route);
+  void storeRoute(const QVector<PathZone*>& route);
+  bool findSegment(unsigned int zone, const LevelGrid::CaseContent& entry, unsigned int targetZone, const LevelGrid::CaseContent& goal, QList<Point>& path);
+  void storeSegment(unsigned int zone, const LevelGrid::CaseContent& entry, unsigned int targetZone, const LevelGrid::CaseContent& goal, const QList<Point>& path);
+  void clear();
+  bool isAvailableToAnyone(const PathZone* from, const PathZone* to) const;
+  const Statistics& getStatistics() const { return statistics; }
+
+private:
+  struct Segment
+  {
+    QList<Point>          path;
+    QVector<ZoneRevision> revisions;
+  };
+
+  bool isValid(const Segment&) const;
+
+  ZoneGrid&                                     zoneGrid;
+  QHash<ZonePair, QVector<unsigned int>>        routes;
+  QHash<ZonePair, QHash<SegmentKey, Segment>>   segments;
+  Statistics                                    statistics;
+};
+
+#endif // PATHCACHE_H
@@ -0,0 +1,191 @@
+#include "pathfindingstore.h"
+#include "zonegrid.h"
+#include "tilemap/tilemap.h"
+#include <QDataStream>
+#include <QFile>
+#include <QDir>
+#include <QDebug>
+
+enum CaseRecordFlag
+{
+  HorizontalWallFlag = 1,
+  VerticalWallFlag   = 2,
+  BlockFlag          = 4,
+  OccupiedFlag       = 8
+};
+
+PathfindingStore::PathfindingStore(const QString& directory, const QByteArray& sourceHash) : directory(directory), sourceHash(sourceHash)
+{
+}
+
+QString PathfindingStore::pathFor(int floorIndex) const
+{
+  return directory + "floor" + QString::number(floorIndex) + ".pathfinding";
+}
+
+bool PathfindingStore::load(const QVector<LevelGrid*>& floors, const QVector<TileMap*>& tilemaps, ZoneGrid& zoneGrid)
+{
+  QVector<PathZone> zones;
+
+  if (sourceHash.isEmpty() || floors.size() != tilemaps.size())
+    return false;
+  for (int i = 0 ; i < floors.size() ; ++i)
+  {
+    if (!loadFloor(i, floors[i], tilemaps[i], zones))
+      return false;
+  }
+  zoneGrid.restoreZoneGrid(floors, zones);
+  return true;
+}
+
+// The file is mapped in memory and parsed into a temporary grid, which only
+// replaces the LevelGrid's content once the whole floor has been read.
+bool PathfindingStore::loadFloor(int floorIndex, LevelGrid* grid, TileMap* tilemap, QVector<PathZone>& zones)
+{
+  QFile                           file(pathFor(floorIndex));
+  uchar*                          mapped;
+  quint32                         fileMagic, fileVersion, caseCount, zoneCount;
+  QByteArray                      fileHash;
+  qint32                          width, height;
+  QVector<LevelGrid::CaseContent> cases;
+  QVector<PathZone>               floorZones;
+
+  if (!file.open(QIODevice::ReadOnly) || !(mapped = file.map(0, file.size())))
+    return false;
+  QByteArray  raw = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), static_cast<int>(file.size()));
+  QDataStream stream(raw);
+
+  stream >> fileMagic >> fileVersion >> fileHash >> width >> height;
+  if (fileMagic != magic || fileVersion != version || fileHash != sourceHash
+   || width != tilemap->getSize().width() || height != tilemap->getSize().height())
+  {
+    qDebug() << "PathfindingStore: outdated file" << file.fileName();
+    return false;
+  }
+  stream >> caseCount;
+  if (caseCount != static_cast<quint32>(width * height))
+    return false;
+  cases.resize(static_cast<int>(caseCount));
+  for (int i = 0 ; i < cases.size() ; ++i)
+  {
+    LevelGrid::CaseContent& gridCase = cases[i];
+    quint8 flags, neighbours;
+    qint8  hcover, vcover, cover;
+
+    stream >> flags >> hcover >> vcover >> cover >> neighbours >> gridCase.pathZone;
+    gridCase.hwall      = flags & HorizontalWallFlag;
+    gridCase.vwall      = flags & VerticalWallFlag;
+    gridCase.block      = flags & BlockFlag;
+    gridCase.occupied   = flags & OccupiedFlag;
+    gridCase.hcover     = hcover;
+    gridCase.vcover     = vcover;
+    gridCase.cover      = cover;
+    gridCase.neighbours = neighbours;
+    gridCase.position   = Point{i % width, i / width, tilemap->getFloor()};
+  }
+  stream >> zoneCount;
+  for (quint32 i = 0 ; i < zoneCount && stream.status() == QDataStream::Ok ; ++i)
+  {
+    PathZone zone;
+    quint32  exitCount;
+
+    stream >> zone.id >> zone.floor >> zone.rect >> zone.positions >> exitCount;
+    if (zone.id != static_cast<unsigned int>(zones.size() + floorZones.size()) + 1)
+      return false;
+    for (quint32 e = 0 ; e < exitCount && stream.status() == QDataStream::Ok ; ++e)
+    {
+      qint32 from;
+      quint8 direction;
+      int    toX, toY;
+
+      stream >> from >> direction;
+      if (from < 0 || from >= cases.size() || direction >= 8)
+        return false;
+      toX = from % width + LevelGrid::neighbourOffsets[direction][0];
+      toY = from / width + LevelGrid::neighbourOffsets[direction][1];
+      if (toX < 0 || toY < 0 || toX >= width || toY >= height)
+        return false;
+      zone.exits.push_back({&cases[from], &cases[toY * width + toX]});
+    }
+    floorZones << zone;
+  }
+  if (stream.status() != QDataStream::Ok)
+    return false;
+  file.unmap(mapped);
+
+  // Commit: exits point into `cases`, which becomes the grid's storage when moved in
+  grid->tilemap = tilemap;
+  grid->size    = tilemap->getSize();
+  grid->links.clear();
+  grid->grid.swap(cases);
+  for (auto& gridCase : grid->grid)
+    gridCase.grid = grid;
+  grid->initializeSightPlane();
+  zones << floorZones;
+  return true;
+}
+
+void PathfindingStore::save(const QVector<LevelGrid*>& floors, const ZoneGrid& zoneGrid)
+{
+  QDir().mkpath(directory);
+  for (int i = 0 ; i < floors.size() ; ++i)
+  {
+    if (!saveFloor(i, floors[i], zoneGrid))
+    {
+      QFile::remove(pathFor(i));
+      qDebug() << "PathfindingStore: could not store floor" << i << "in" << directory;
+    }
+  }
+}
+
+bool PathfindingStore::saveFloor(int floorIndex, LevelGrid* grid, const ZoneGrid& zoneGrid)
+{
+  QFile       file(pathFor(floorIndex));
+  QDataStream stream;
+  const int   width = grid->size.width();
+  quint32     zoneCount = 0;
+  unsigned char floor = grid->getTilemap()->getFloor();
+
+  // Links are added by objects (doorways, elevators) after the grid has been
+  // prepared: at this point, a floor with links can't be described by masks.
+  if (!grid->links.isEmpty() || !file.open(QIODevice::WriteOnly))
+    return false;
+  stream.setDevice(&file);
+  stream << magic << version << sourceHash
+         << static_cast<qint32>(grid->size.width()) << static_cast<qint32>(grid->size.height())
+         << static_cast<quint32>(grid->grid.size());
+  for (const LevelGrid::CaseContent& gridCase : qAsConst(grid->grid))
+  {
+    quint8 flags = (gridCase.hwall    ? HorizontalWallFlag : 0)
+                 | (gridCase.vwall    ? VerticalWallFlag   : 0)
+                 | (gridCase.block    ? BlockFlag          : 0)
+                 | (gridCase.occupied ? OccupiedFlag       : 0);
+
+    stream << flags
+           << static_cast<qint8>(gridCase.hcover) << static_cast<qint8>(gridCase.vcover) << static_cast<qint8>(gridCase.cover)
+           << static_cast<quint8>(gridCase.neighbours) << static_cast<quint32>(gridCase.pathZone);
+  }
+  for (const PathZone& zone : zoneGrid.zones)
+  {
+    if (zone.floor == floor)
+      zoneCount++;
+  }
+  stream << zoneCount;
+  for (const PathZone& zone : zoneGrid.zones)
+  {
+    if (zone.floor != floor)
+      continue ;
+    stream << static_cast<quint32>(zone.id) << static_cast<quint8>(zone.floor) << zone.rect << zone.positions
+           << static_cast<quint32>(zone.exits.size());
+    for (const PathZone::Connection& exit : zone.exits)
+    {
+      int direction = LevelGrid::neighbourDirection(exit.second->position.x - exit.first->position.x,
+                                                    exit.second->position.y - exit.first->position.y);
+
+      if (direction < 0 || exit.second->position.z != floor)
+        return false;
+      stream << static_cast<qint32>(grid->indexOf(*exit.first)) << static_cast<quint8>(direction);
+    }
+  }
+  return stream.status() == QDataStream::Ok;
+}
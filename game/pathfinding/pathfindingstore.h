@@ -0,0 +1,36 @@
+#ifndef  PATHFINDINGSTORE_H
+# define PATHFINDINGSTORE_H
+
+# include <QString>
+# include <QByteArray>
+# include <QVector>
+
+class LevelGrid;
+class ZoneGrid;
+class TileMap;
+struct PathZone;
+
+// Binary copy of the walkability graph and zone partition of each floor,
+// stored next to the prerendered tilemaps. Files are only trusted when their
+// format version and the source hash match: the caller hashes the tilemap,
+// its tilesets, and anything else the grid depends on.
+class PathfindingStore
+{
+  static const quint32 magic   = 0x50464e44; // "PFND"
+  static const quint32 version = 1;
+public:
+  PathfindingStore(const QString& directory, const QByteArray& sourceHash);
+
+  bool load(const QVector<LevelGrid*>& floors, const QVector<TileMap*>& tilemaps, ZoneGrid&);
+  void save(const QVector<LevelGrid*>& floors, const ZoneGrid&);
+
+private:
+  QString pathFor(int floorIndex) const;
+  bool    loadFloor(int floorIndex, LevelGrid*, TileMap*, QVector<PathZone>& zones);
+  bool    saveFloor(int floorIndex, LevelGrid*, const ZoneGrid&);
+
+  QString    directory;
+  QByteArray sourceHash;
+};
+
+#endif // PATHFINDINGSTORE_H
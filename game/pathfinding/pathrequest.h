@@ -0,0 +1,29 @@
+#ifndef  PATHREQUEST_H
+# define PATHREQUEST_H
+
+# include <QList>
+# include <QVector>
+# include <memory>
+# include "utils/point.h"
+
+class CharacterMovement;
+
+// A path search queued on the ZoneGrid, resolved along with the other
+// requests of the same tick. The requester keeps a reference to it and
+// polls `resolved`; cancelling only flags the request, so that it can be
+// dropped safely whichever of the requester or the ZoneGrid goes first.
+struct PathRequest
+{
+  CharacterMovement* character = nullptr;
+  Point              from;
+  QVector<Point>     to;
+  bool               quickMode = false;
+  bool               cancelled = false;
+  bool               resolved  = false;
+  bool               found     = false;
+  QList<Point>       path;
+};
+
+typedef std::shared_ptr<PathRequest> PathRequestPtr;
+
+#endif // PATHREQUEST_H
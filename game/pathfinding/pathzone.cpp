@@ -12,18 +12,6 @@ float PathZone::GoalDistanceEstimate(const PathZone& other)
   return std::sqrt(static_cast<float>(distX * distX + distY * distY)) + static_cast<float>(distFloor * 10);
 }
 
-std::list<PathZone*> PathZone::GetSuccessors(const PathZone* parent, Actor* actor) const
-{
-  std::list<PathZone*> list;
-
-  for (auto it = connections.keyBegin() ; it != connections.keyEnd() ; ++it)
-  {
-    if ((!parent || (*it)->id != parent->id) && isConnected(*it, actor))
-      list.push_back(*it);
-  }
-  return list;
-}
-
 const PathZone::Connections* PathZone::getExitsTowards(const PathZone* target) const
 {
   for (auto it = connections.begin() ; it != connections.end() ; ++it)
@@ -42,9 +30,9 @@ bool PathZone::isConnected(const PathZone* target, Actor* actor) const
   {
     for (auto it = candidates->begin() ; it != candidates->end() ; ++it)
     {
-      LevelGrid::CaseConnection* connection = it->first->connectionWith(it->second);
+      LevelGrid::CaseConnection connection = it->first->connectionWith(it->second);
 
-      if (connection && connection->canGoThrough(actor))
+      if (connection.isValid() && connection.canGoThrough(actor))
         return true;
     }
   }
@@ -4,7 +4,6 @@
 # include <QRect>
 # include <QVector>
 # include <QMap>
-# include <list>
 # include "utils/point.h"
 # include "levelgrid.h"
 
@@ -17,6 +16,7 @@ struct PathZone
   typedef QVector<Connection> Connections;
 
   unsigned int       id;
+  unsigned int       revision = 0;
   QRect              rect;
   QVector<QPoint>    positions;
   unsigned char      floor;
@@ -50,7 +50,17 @@ struct PathZone
   bool  operator< (const PathZone& other) const { return Point(*this) < Point(other); }
   float GetCost(const PathZone&, const Actor*) { return 1; }
   float GoalDistanceEstimate(const PathZone&);
-  std::list<PathZone*> GetSuccessors(const PathZone* parent, Actor*) const;
+  unsigned int GetSearchKey() const { return id; }
+
+  template<typename FUNCTOR>
+  void EachSuccessor(const PathZone* parent, Actor* actor, FUNCTOR callback) const
+  {
+    for (auto it = connections.keyBegin() ; it != connections.keyEnd() ; ++it)
+    {
+      if ((!parent || (*it)->id != parent->id) && isConnected(*it, actor))
+        callback(*it);
+    }
+  }
 };
 
 #endif // PATHZONE_H
@@ -5,11 +5,11 @@ static bool isWall(const TileLayer* layer, int x, int y)
 {
   if (layer)
   {
-    Tile* tile = layer->getTile(x, y);
+    Tile tile = layer->getTile(x, y);
 
     if (tile)
     {
-      QVariant doorwayProp = tile->getProperty("doorway");
+      QVariant doorwayProp = tile.getProperty("doorway");
 
       return doorwayProp.isNull() || doorwayProp.toBool() == false;
     }
@@ -21,11 +21,11 @@ static char getCoverValue(const TileLayer* layer, const LevelGrid::CaseContent&
 {
   if (layer)
   {
-    Tile* tile = layer->getTile(caseContent.position.x, caseContent.position.y);
+    Tile tile = layer->getTile(caseContent.position.x, caseContent.position.y);
 
     if (tile)
     {
-      QVariant coverProp = tile->getProperty("cover");
+      QVariant coverProp = tile.getProperty("cover");
 
       if (!coverProp.isNull())
         return static_cast<char>(coverProp.toInt());
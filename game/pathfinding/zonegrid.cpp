@@ -2,7 +2,7 @@
 #include "candidatesolution.h"
 #include "tilemap/tilemap.h"
 
-ZoneGrid::ZoneGrid()
+ZoneGrid::ZoneGrid() : cache(*this)
 {
 
 }
@@ -19,16 +19,15 @@ LevelGrid::CaseContent* ZoneGrid::getGridCase(Point position)
 
 PathZone* ZoneGrid::getPathZone(Point position)
 {
-  for (PathZone& zone : zones)
-  {
-    if (zone.contains(position))
-      return &zone;
-  }
-  return nullptr;
+  auto* gridCase = getGridCase(position);
+
+  return gridCase && gridCase->pathZone ? getPathZoneById(gridCase->pathZone) : nullptr;
 }
 
 PathZone* ZoneGrid::getPathZoneById(unsigned int id)
 {
+  if (id > 0 && id <= static_cast<unsigned int>(zones.size()) && zones[static_cast<int>(id) - 1].id == id)
+    return &zones[static_cast<int>(id) - 1];
   auto it = std::find(zones.begin(), zones.end(), id);
 
   return it == zones.end() ? nullptr : &(*it);
@@ -41,13 +40,33 @@ void ZoneGrid::connectCases(Point a, Point b)
   auto* caseB = getGridCase(b);
   auto* zoneB = getPathZone(b);
 
-  if (caseA && caseB && zoneA && zoneB && caseA->connectionWith(caseB) == nullptr)
+  if (caseA && caseB && !caseA->connectionWith(caseB).isValid())
   {
     caseA->connectWith(caseB);
-    if (zoneA != zoneB)
+    invalidateTopology();
+    if (!zoneA || !zoneB)
     {
-      zoneA->addExitTowards(zoneB, {caseA, caseB});
-      zoneB->addExitTowards(zoneA, {caseB, caseA});
+      // a case that had no connections yet joins the zones of its cell
+      if (!zoneA)
+        repartitionCell(a);
+      if (!zoneB)
+        repartitionCell(b);
+      // zones may have moved, and the one that already existed lacks the link
+      zoneA = getPathZone(a);
+      zoneB = getPathZone(b);
+    }
+    if (zoneA && zoneB && zoneA != zoneB)
+    {
+      if (!zoneA->exits.contains({caseA, caseB}))
+      {
+        zoneA->exits.push_back({caseA, caseB});
+        zoneA->addExitTowards(zoneB, {caseA, caseB});
+      }
+      if (!zoneB->exits.contains({caseB, caseA}))
+      {
+        zoneB->exits.push_back({caseB, caseA});
+        zoneB->addExitTowards(zoneA, {caseB, caseA});
+      }
     }
   }
 }
@@ -59,11 +78,16 @@ void ZoneGrid::disconnectCases(Point a, Point b)
   auto* caseB = getGridCase(b);
   auto* zoneB = getPathZone(b);
 
-  if (caseA && caseB && caseA->connectionWith(caseB) != nullptr)
+  if (caseA && caseB && caseA->connectionWith(caseB).isValid())
   {
     caseA->disconnectFrom(caseB);
-    if (zoneA != zoneB)
+    invalidateTopology();
+    if (zoneA && zoneA == zoneB)
+      repartitionCell(a); // the zone might have been split in two
+    else if (zoneA && zoneB)
     {
+      zoneA->exits.removeOne({caseA, caseB});
+      zoneB->exits.removeOne({caseB, caseA});
       zoneA->removeExitTowards(zoneB, {caseA, caseB});
       zoneB->removeExitTowards(zoneA, {caseB, caseA});
     }
@@ -75,6 +99,19 @@ bool ZoneGrid::findPath(Point from, Point to, QList<Point>& path, CharacterMovem
   return findPath(from, QVector<Point>{to}, path, character);
 }
 
+void ZoneGrid::invalidateCase(Point position)
+{
+  PathZone* zone = getPathZone(position);
+
+  if (zone)
+    zone->revision++;
+}
+
+void ZoneGrid::invalidateTopology()
+{
+  cache.clear();
+}
+
 int ZoneGrid::actionPointCost(Point a, Point b)
 {
   const auto* caseA = getGridCase(a);
@@ -3,6 +3,10 @@
 
 # include "pathzone.h"
 # include "levelgrid.h"
+# include "astar.hpp"
+# include "pathcache.h"
+# include "pathrequest.h"
+# include "zonepartitioner.h"
 
 class LevelGrid;
 
@@ -12,11 +16,16 @@ public:
   ZoneGrid();
 
   void prepareZoneGrid(QVector<LevelGrid*> levels);
+  void restoreZoneGrid(QVector<LevelGrid*> levels, const QVector<PathZone>& zones);
   bool findPath(Point from, Point to, QList<Point>& path, CharacterMovement* character);
   bool findPath(Point from, const QVector<Point> &to, QList<Point> &path, CharacterMovement *character, bool quickMode = false);
   void connectCases(Point, Point);
   void disconnectCases(Point, Point);
+  void repartitionCell(Point);
+  PathRequestPtr requestPath(Point from, const QVector<Point>& to, CharacterMovement* character, bool quickMode = false);
+  void resolvePathRequests();
   int actionPointCost(Point, Point);
+  void invalidateCase(Point);
 
   LevelGrid::CaseContent* getGridCase(Point);
   PathZone*               getPathZone(Point);
@@ -24,6 +33,21 @@ public:
 
   QVector<LevelGrid*> levels;
   QVector<PathZone>   zones;
+
+  AstarSearchContext<LevelGrid::CaseContent> caseSearch;
+  AstarSearchContext<PathZone>               zoneSearch;
+  PathCache                                  cache;
+  ZonePartitioner                            partitioner;
+
+private:
+  void setLevels(const QVector<LevelGrid*>&);
+  void connectPathZone(PathZone&);
+  void registerPathZone(PathZone&);
+  void removeEmptyZones(QVector<unsigned int> emptied, QVector<unsigned int>& affected, QVector<unsigned int>& touched);
+  void prepareRoutesTowards(PathZone* target, const QVector<PathRequestPtr>& requests);
+  void invalidateTopology();
+
+  QVector<PathRequestPtr> pendingRequests;
 };
 
 #endif // ZONEGRID_H
@@ -0,0 +1,82 @@
+#include "zonegrid.h"
+#include <QHash>
+#include <QDebug>
+
+PathRequestPtr ZoneGrid::requestPath(Point from, const QVector<Point>& to, CharacterMovement* character, bool quickMode)
+{
+  PathRequestPtr request = std::make_shared<PathRequest>();
+
+  request->character = character;
+  request->from      = from;
+  request->to        = to;
+  request->quickMode = quickMode;
+  pendingRequests << request;
+  return request;
+}
+
+// Runs a single reverse breadth-first search from the target zone, only going
+// through the zone exits that any actor can use. Each zone reached that way
+// learns its next step towards the target, and the route of each requester is
+// stored in the path cache, so that their own searches start with a cache hit.
+void ZoneGrid::prepareRoutesTowards(PathZone* target, const QVector<PathRequestPtr>& requests)
+{
+  QVector<PathZone*> nextStep(zones.size() + 1, nullptr);
+  QVector<bool>      reached(zones.size() + 1, false);
+  QVector<PathZone*> queue{target};
+
+  reached[static_cast<int>(target->id)] = true;
+  for (int i = 0 ; i < queue.size() ; ++i)
+  {
+    PathZone* zone = queue[i];
+
+    for (auto it = zone->connections.keyBegin() ; it != zone->connections.keyEnd() ; ++it)
+    {
+      PathZone* neighbour = *it;
+      int       index     = static_cast<int>(neighbour->id);
+
+      if (index < reached.size() && !reached[index] && cache.isAvailableToAnyone(neighbour, zone))
+      {
+        reached[index]   = true;
+        nextStep[index]  = zone;
+        queue << neighbour;
+      }
+    }
+  }
+  for (const PathRequestPtr& request : requests)
+  {
+    PathZone*          zone = getPathZone(request->from);
+    QVector<PathZone*> route;
+
+    if (!zone || zone == target || !reached[static_cast<int>(zone->id)])
+      continue ;
+    for (; zone ; zone = nextStep[static_cast<int>(zone->id)])
+      route << zone;
+    cache.storeRoute(route);
+  }
+}
+
+void ZoneGrid::resolvePathRequests()
+{
+  QVector<PathRequestPtr>                      requests;
+  QHash<unsigned int, QVector<PathRequestPtr>> groups;
+
+  requests.swap(pendingRequests);
+  for (const PathRequestPtr& request : qAsConst(requests))
+  {
+    PathZone* targetZone = !request->cancelled && request->to.size() > 0 ? getPathZone(request->to.first()) : nullptr;
+
+    if (targetZone)
+      groups[targetZone->id] << request;
+  }
+  for (auto it = groups.begin() ; it != groups.end() ; ++it)
+  {
+    if (it->size() > 1)
+      prepareRoutesTowards(getPathZoneById(it.key()), *it);
+  }
+  for (const PathRequestPtr& request : qAsConst(requests))
+  {
+    if (!request->cancelled)
+      request->found = findPath(request->from, request->to, request->path, request->character, request->quickMode);
+    request->resolved = true;
+  }
+}
@@ -18,27 +18,35 @@ static bool sortCasesByProximity(
 
 static CasePathfinder::CandidateList sortedCaseCandidates(const PathZone::Connections& connections, CaseSorter heuristic)
 {
-  std::vector<LevelGrid::CaseContent> sortableCandidates;
+  CasePathfinder::CandidateList candidates;
 
+  candidates.reserve(static_cast<size_t>(connections.size()));
   for (const auto connection : connections)
-    sortableCandidates.push_back(*connection.second);
-  std::sort(sortableCandidates.begin(), sortableCandidates.end(), heuristic);
-  return CasePathfinder::CandidateList(sortableCandidates.begin(), sortableCandidates.end());
+    candidates.push_back(connection.second);
+  std::sort(candidates.begin(), candidates.end(), [&heuristic](const LevelGrid::CaseContent* a, const LevelGrid::CaseContent* b)
+  {
+    return heuristic(*a, *b);
+  });
+  return candidates;
 }
 
 static bool findPathToZone(
-    PathZone*               fromZone,
-    LevelGrid::CaseContent* fromCase,
-    PathZone*               toZone,
-    CaseSorter              heuristic,
-    QList<Point>&           path,
-    CharacterMovement*      character)
+    ZoneGrid&                     zoneGrid,
+    PathZone*                     fromZone,
+    LevelGrid::CaseContent*       fromCase,
+    PathZone*                     toZone,
+    const LevelGrid::CaseContent& goal,
+    CaseSorter                    heuristic,
+    QList<Point>&                 path,
+    CharacterMovement*            character)
 {
   auto* exits = fromZone->getExitsTowards(toZone);
 
+  if (zoneGrid.cache.findSegment(fromZone->id, *fromCase, toZone->id, goal, path))
+    return true;
   if (exits && exits->size() > 0)
   {
-    CasePathfinder                astar(character);
+    CasePathfinder                astar(character, &zoneGrid.caseSearch);
     CasePathfinder::Solution*     solution;
     CasePathfinder::CandidateList candidates = sortedCaseCandidates(*exits, heuristic);
     unsigned short                iteractionCount = 0;
@@ -50,8 +58,12 @@ static bool findPathToZone(
     solution = astar.GetBestSolution();
     if (solution)
     {
+      QList<Point> segment;
+
       for (auto it = ++solution->begin() ; it != solution->end() ; ++it)
-        path << it->position;
+        segment << (*it)->position;
+      zoneGrid.cache.storeSegment(fromZone->id, *fromCase, toZone->id, goal, segment);
+      path << segment;
       return true;
     }
     else
@@ -62,37 +74,59 @@ static bool findPathToZone(
   return false;
 }
 
-static bool findZonePathToZone(
-    ZoneGrid&               zoneGrid,
-    PathZone*               fromZone,
-    LevelGrid::CaseContent* fromCase,
-    PathZone*               toZone,
-    CaseSorter              heuristic,
-    QList<Point>&           path,
-    CharacterMovement*      character
-    )
+static bool findZoneRoute(
+    ZoneGrid&           zoneGrid,
+    PathZone*           fromZone,
+    PathZone*           toZone,
+    QVector<PathZone*>& route,
+    CharacterMovement*  character)
 {
-  ZonePathfinder            astar(character);
+  ZonePathfinder            astar(character, &zoneGrid.zoneSearch);
   ZonePathfinder::Solution* solution;
   unsigned short            iterationCount = 0;
 
+  if (zoneGrid.cache.findRoute(fromZone->id, toZone->id, route))
+    return true;
   qDebug() << "-> AStar looking for path between" << fromZone->rect << "and" << toZone->rect;
-  astar.SetStartAndGoalStates(*fromZone, {*toZone});
+  astar.SetStartAndGoalStates(*fromZone, {toZone});
   while (astar.SearchStep() == ZonePathfinder::Searching && iterationCount < 250);
   solution = astar.GetBestSolution();
   if (solution)
+  {
+    for (PathZone* zone : *solution)
+      route << zone;
+    zoneGrid.cache.storeRoute(route);
+    return true;
+  }
+  return false;
+}
+
+static bool findZonePathToZone(
+    ZoneGrid&                     zoneGrid,
+    PathZone*                     fromZone,
+    LevelGrid::CaseContent*       fromCase,
+    PathZone*                     toZone,
+    const LevelGrid::CaseContent& goal,
+    CaseSorter                    heuristic,
+    QList<Point>&                 path,
+    CharacterMovement*            character
+    )
+{
+  QVector<PathZone*> route;
+
+  if (findZoneRoute(zoneGrid, fromZone, toZone, route, character))
   {
     auto* stepState = fromCase;
-    auto  stepIt    = solution->begin();
-    auto* stepZone  = zoneGrid.getPathZoneById(solution->begin()->id);
+    auto  stepIt    = route.begin();
+    auto* stepZone  = *stepIt;
 
-    if (solution->size() > 1)
+    if (route.size() > 1)
      stepIt++;
-    while (stepIt != solution->end())
+    while (stepIt != route.end())
     {
-      auto* nextZone = zoneGrid.getPathZoneById(stepIt->id);
+      auto* nextZone = *stepIt;
 
-      if (findPathToZone(stepZone, stepState, nextZone, heuristic, path, character))
+      if (findPathToZone(zoneGrid, stepZone, stepState, nextZone, goal, heuristic, path, character))
       {
         stepState = zoneGrid.getGridCase(path.last());
         stepZone  = nextZone;
@@ -101,7 +135,7 @@ static bool findZonePathToZone(
       else
         break ;
     }
-    return stepIt == solution->end();
+    return stepIt == route.end();
   }
   else
     qDebug() << "-> AStar claims there's no way";
@@ -116,7 +150,7 @@ bool ZoneGrid::findPath(Point from, const QVector<Point> &to, QList<Point> &path
   if (!targetCase || !fromCase || !fromZone) return false;
   CandidateSolutions                 candidates(*this, to);
   CandidateSolutions::const_iterator candidate;
-  CaseSorter                         heuristic = std::bind(&sortCasesByProximity, *targetCase, std::placeholders::_1, std::placeholders::_2);
+  CaseSorter                         heuristic = std::bind(&sortCasesByProximity, std::cref(*targetCase), std::placeholders::_1, std::placeholders::_2);
   CaseLocker                         caseLock(fromCase);
 
   qDebug() << character << "findPath" << candidates.length();
@@ -133,13 +167,13 @@ bool ZoneGrid::findPath(Point from, const QVector<Point> &to, QList<Point> &path
         qDebug() << "-> finding path towards zone";
         failed = !findZonePathToZone(*this,
                                         fromZone, fromCase, candidate->zone,
-                                        heuristic, currentPath, character);
+                                        *targetCase, heuristic, currentPath, character);
       }
       else
         qDebug() << "-> skipping zone pathvinding (target is in start zone)";
       if (!failed)
       {
-        CasePathfinder            astar(character);
+        CasePathfinder            astar(character, &caseSearch);
         CasePathfinder::Solution* solution;
         LevelGrid::CaseContent*   stepCase = currentPath.size() ? getGridCase(currentPath.last()) : fromCase;
         unsigned short            iterationCount = 0;
@@ -153,7 +187,7 @@ bool ZoneGrid::findPath(Point from, const QVector<Point> &to, QList<Point> &path
         if (solution)
         {
           for (auto it = ++solution->begin() ; it != solution->end() ; ++it)
-            currentPath.push_back(it->position);
+            currentPath.push_back((*it)->position);
           qDebug() << "-> path to target case found" << currentPath.size();
         }
         else
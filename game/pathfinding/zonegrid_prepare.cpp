@@ -1,247 +1,152 @@
 #include "zonegrid.h"
-#include <cmath>
 #include <QDebug>
+#include <algorithm>
+#include <functional>
 #include "tilemap/tilemap.h"
 #define ZONE_GRANULARITY 10
 
-static void detectZoneBoundaries(PathZone& zone)
+static QPoint cellOf(QPoint position, int granularity)
 {
-  QPoint topLeft, bottomRight;
-  auto it = zone.positions.begin();
-
-  topLeft = bottomRight = *it;
-  while (++it != zone.positions.end())
-  {
-    if (it->x() < topLeft.x())
-      topLeft.setX(it->x());
-    if (it->y() < topLeft.y())
-      topLeft.setY(it->y());
-    if (it->x() > bottomRight.x())
-      bottomRight.setX(it->x());
-    if (it->y() > bottomRight.y())
-      bottomRight.setY(it->y());
-  }
-  zone.rect = QRect(topLeft, bottomRight);
+  return QPoint(position.x() / granularity, position.y() / granularity);
 }
 
-static QVector<PathZone> makePathZonesFrom(QVector<LevelGrid::CaseContent*> missingCases)
+static QRect cellRect(QPoint cell, int granularity)
 {
-  PathZone zone;
-  QVector<PathZone> zoneList;
-  QVector<LevelGrid::CaseContent*> aggregatedCases;
-
-  if (missingCases.size() > 0)
-  {
-    // - start by registering the initial case
-    // - aggregatedCases will then be progressively filled with explorable nodes
-    zone.positions.push_back(missingCases.first()->position);
-    zone.floor = missingCases.first()->position.z;
-    aggregatedCases.push_back(*missingCases.begin());
-    missingCases.pop_front();
-    for (int caseIt = 0 ; caseIt < aggregatedCases.size() ; ++caseIt)
-    {
-      auto* currentCase = aggregatedCases[caseIt];
-
-      // - loop over all the cases connected to the currentCase
-      // - check if each candidate was part of the collected cases in step1
-      // - if they are, add it to the explorable list, and remove it from the list o cases to check
-      for (auto* caseConnection : currentCase->connections)
-      {
-        auto* candidateCase = caseConnection->getTargetFor(currentCase);
-        auto it = std::find(missingCases.begin(), missingCases.end(), candidateCase);
-
-        if (it != missingCases.end())
-        {
-          zone.positions.push_back(candidateCase->position);
-          aggregatedCases.push_back(candidateCase);
-          missingCases.erase(it);
-        }
-      }
-    }
-
-    // - loop over all the aggregated cases again
-    // - find connections to cases that are not aggregated
-    // - register these cases as connections to other zones
-    for (auto* currentCase : aggregatedCases)
-    {
-      for (auto* caseConnection : currentCase->connections)
-      {
-        auto* candidateCase = caseConnection->getTargetFor(currentCase);
-        auto it = std::find(aggregatedCases.begin(), aggregatedCases.end(), candidateCase);
-
-        if (it == aggregatedCases.end())
-          zone.exits.push_back({currentCase, candidateCase});
-      }
-    }
-    detectZoneBoundaries(zone);
-    if (zone.positions.size() > 1 || zone.exits.size() > 0)
-      zoneList << zone;
-    zoneList << makePathZonesFrom(missingCases);
-  }
-  return zoneList;
+  return QRect(cell.x() * granularity, cell.y() * granularity, granularity, granularity);
 }
 
-static QVector<PathZone> subdivideZoneGrid(QRect rect, LevelGrid* grid)
+static QVector<LevelGrid::CaseContent*> getConnectedCases(LevelGrid* grid, QRect rect)
 {
   QVector<LevelGrid::CaseContent*> cases;
 
-  // step 1: register all the cases within the zone
-  for (int x = rect.left() ; x < rect.right() ; ++x)
+  rect = rect.intersected(QRect(QPoint(0, 0), grid->getSize()));
+  for (int x = rect.left() ; x <= rect.right() ; ++x)
   {
-    for (int y = rect.top() ; y < rect.bottom() ; ++y)
+    for (int y = rect.top() ; y <= rect.bottom() ; ++y)
     {
       auto* gridCase = grid->getGridCase(x, y);
 
-      if (gridCase && gridCase->connections.size())
+      if (gridCase && gridCase->hasConnections())
         cases.push_back(gridCase);
     }
   }
-  return makePathZonesFrom(cases);
-}
-
-static void adjustZoneSize(QRect& zoneSize, QPoint position)
-{
-  if (position.x() < zoneSize.x())
-    zoneSize.setLeft(position.x());
-  else if (position.x() > zoneSize.x())
-    zoneSize.setRight(position.x());
-  if (position.y() < zoneSize.y())
-    zoneSize.setTop(position.y());
-  else if (position.y() > zoneSize.bottom())
-    zoneSize.setBottom(position.y());
-}
-
-static QVector<LevelGrid::CaseContent*> getCaseSubset(const QVector<LevelGrid::CaseContent*>& cases, QRect rect)
-{
-  QVector<LevelGrid::CaseContent*> subset;
-
-  for (auto it = cases.begin() ; it != cases.end() ; ++it)
-  {
-    if (rect.contains((*it)->position))
-      subset.push_back(*it);
-  }
-  return subset;
+  return cases;
 }
 
-static QVector<PathZone> subdivicePathZoneFromLayer(QRect zoneSize, QVector<LevelGrid::CaseContent*>& cases)
+// Cases are bucketed by cell in a single pass, then each cell is partitioned on its own
+static QVector<PathZone> subdivideCases(ZonePartitioner& partitioner, const QVector<LevelGrid::CaseContent*>& cases, int granularity)
 {
+  QMap<QPair<int, int>, QVector<LevelGrid::CaseContent*>> cells;
   QVector<PathZone> zones;
-  QVector<QRect>    parts;
-  const int         granularityInt = ZONE_GRANULARITY;
-  const double      granularity = static_cast<double>(granularityInt);
-  const QPoint      zoneBaseSize(granularityInt, granularityInt);
 
-  for (int x = 0 ; x < std::ceil(zoneSize.width() / granularity) ; ++x)
+  for (auto* gridCase : cases)
   {
-    for (int y = 0 ; y < std::ceil(zoneSize.height() / granularity) ; ++y)
-    {
-      QPoint   topLeft(x * granularityInt, y * granularityInt);
+    QPoint cell = cellOf(gridCase->position, granularity);
 
-      parts << QRect(topLeft, topLeft + zoneBaseSize);
-    }
+    cells[{cell.x(), cell.y()}].push_back(gridCase);
   }
-  for (const auto& part : parts)
-    zones << makePathZonesFrom(getCaseSubset(cases, part));
+  for (const auto& cellCases : cells)
+    zones << partitioner.partition(cellCases);
   return zones;
 }
 
-static QVector<PathZone> preparePathZoneFromLayer(LevelGrid* grid, const TileZone* source, QVector<LevelGrid::CaseContent*>& allCases)
+static QVector<PathZone> preparePathZoneFromLayer(ZonePartitioner& partitioner, LevelGrid* grid, const TileZone* source, QVector<bool>& claimed)
 {
   QVector<LevelGrid::CaseContent*> cases;
-  const auto& positions = source->getPositions();
   QRect zoneSize;
   int granularity = source->getGranularity();
 
-  if (allCases.size() > 1)
+  for (QPoint position : source->getPositions())
   {
-    QPoint origin(allCases.first()->position);
-    zoneSize = QRect(origin, origin);
-  }
-  for (auto it = allCases.begin() ; it != allCases.end() ;)
-  {
-    auto* gridCase = *it;
+    auto* gridCase = grid->getGridCase(position.x(), position.y());
+    int   index    = position.y() * grid->getSize().width() + position.x();
 
-    adjustZoneSize(zoneSize, gridCase->position);
-    if (positions.indexOf(gridCase->position) >= 0)
+    if (gridCase && gridCase->hasConnections() && !claimed[index])
     {
+      claimed[index] = true;
       cases.push_back(gridCase);
-      it = allCases.erase(it);
+      zoneSize = zoneSize.isNull() ? QRect(position, position) : zoneSize.united(QRect(position, position));
     }
-    else
-      ++it;
   }
   if (granularity == 0)
     granularity = ZONE_GRANULARITY;
   if (granularity > 0 && (zoneSize.width() > granularity || zoneSize.height() > granularity))
-    return subdivicePathZoneFromLayer(zoneSize, cases);
-  return makePathZonesFrom(cases);
+    return subdivideCases(partitioner, cases, ZONE_GRANULARITY);
+  return partitioner.partition(cases);
 }
 
 static void prepareZoneGridForFloorUsingTilemap(ZoneGrid& zoneGrid, LevelGrid* grid)
 {
   const auto& mapZones = grid->getTilemap()->getPathfindindingZones();
-  QVector<LevelGrid::CaseContent*> allCases;
+  QVector<bool> claimed(grid->getSize().width() * grid->getSize().height(), false);
+  QVector<LevelGrid::CaseContent*> remainingCases;
 
-  for (int x = 0 ; x < grid->getSize().width() ; ++x)
+  for (const auto* mapZone : mapZones)
+    zoneGrid.zones << preparePathZoneFromLayer(zoneGrid.partitioner, grid, mapZone, claimed);
+  for (auto* gridCase : getConnectedCases(grid, QRect(QPoint(0, 0), grid->getSize())))
   {
-    for (int y = 0 ; y < grid->getSize().height() ; ++y)
-    {
-      auto* gridCase = grid->getGridCase(x, y);
-
-      if (gridCase && gridCase->connections.size())
-        allCases.push_back(gridCase);
-    }
+    if (!claimed[gridCase->position.y * grid->getSize().width() + gridCase->position.x])
+      remainingCases.push_back(gridCase);
   }
-  for (const auto* mapZone : mapZones)
-    zoneGrid.zones << preparePathZoneFromLayer(grid, mapZone, allCases);
-  if (allCases.size() > 0)
-    zoneGrid.zones << makePathZonesFrom(allCases);
+  if (remainingCases.size() > 0)
+    zoneGrid.zones << zoneGrid.partitioner.partition(remainingCases);
 }
 
 static void prepareZoneGridForFloor(ZoneGrid& zoneGrid, LevelGrid* grid)
 {
-  QVector<QRect> parts;
-  const int      granularityInt = ZONE_GRANULARITY;
-  const double   granularity = static_cast<double>(granularityInt);
-  const QPoint   zoneBaseSize(granularityInt, granularityInt);
+  const int granularity = ZONE_GRANULARITY;
+  const int width  = (grid->getSize().width()  + granularity - 1) / granularity;
+  const int height = (grid->getSize().height() + granularity - 1) / granularity;
 
-  for (int x = 0 ; x < std::ceil(grid->getSize().width() / granularity) ; ++x)
+  for (int x = 0 ; x < width ; ++x)
   {
-    for (int y = 0 ; y < std::ceil(grid->getSize().height() / granularity) ; ++y)
-    {
-      QPoint   topLeft(x * granularityInt, y * granularityInt);
-
-      parts << QRect(topLeft, topLeft + zoneBaseSize);
-    }
+    for (int y = 0 ; y < height ; ++y)
+      zoneGrid.zones << zoneGrid.partitioner.partition(getConnectedCases(grid, cellRect(QPoint(x, y), granularity)));
   }
-  for (const auto& part : parts)
-    zoneGrid.zones << subdivideZoneGrid(part, grid);
 }
 
-static void connectPathZones(PathZone& zone, QVector<PathZone>& zones)
+void ZoneGrid::connectPathZone(PathZone& zone)
 {
+  zone.connections.clear();
   for (const PathZone::Connection& exit : zone.exits)
   {
-    for (PathZone& candidate : zones)
-    {
-      if (candidate.contains(exit.second->position))
-      {
-        auto it = zone.connections.find(&candidate);
+    PathZone* candidate = getPathZoneById(exit.second->pathZone);
 
-        if (it == zone.connections.end())
-          zone.connections.insert(&candidate, {exit});
-        else
-          it->push_back(exit);
-      }
-    }
+    if (candidate && candidate != &zone)
+      zone.addExitTowards(candidate, exit);
+  }
+}
+
+void ZoneGrid::registerPathZone(PathZone& zone)
+{
+  for (QPoint position : zone.positions)
+  {
+    auto* gridCase = getGridCase({position.x(), position.y(), zone.floor});
+
+    if (gridCase && gridCase->pathZone == 0)
+      gridCase->pathZone = zone.id;
   }
 }
 
+void ZoneGrid::setLevels(const QVector<LevelGrid*>& grids)
+{
+  unsigned int searchKeyOffset = 0;
+
+  levels = grids;
+  for (LevelGrid* grid : grids)
+  {
+    grid->setSearchKeyOffset(searchKeyOffset);
+    searchKeyOffset += grid->getCaseCount();
+  }
+  partitioner.reset(searchKeyOffset);
+}
+
 void ZoneGrid::prepareZoneGrid(QVector<LevelGrid*> grids)
 {
   unsigned int n = 1;
 
-  levels = grids;
+  setLevels(grids);
+  zones.clear();
   for (LevelGrid* grid : grids)
   {
     if (grid->hasPathfindingZones())
@@ -252,6 +157,160 @@ void ZoneGrid::prepareZoneGrid(QVector<LevelGrid*> grids)
   for (PathZone& zone : zones)
   {
     zone.id = n++;
-    connectPathZones(zone, zones);
+    registerPathZone(zone);
+  }
+  for (PathZone& zone : zones)
+    connectPathZone(zone);
+  invalidateTopology();
+}
+
+// Zones loaded by the PathfindingStore already carry their ids, and the
+// cases already know which zone they belong to.
+void ZoneGrid::restoreZoneGrid(QVector<LevelGrid*> grids, const QVector<PathZone>& restoredZones)
+{
+  setLevels(grids);
+  zones = restoredZones;
+  for (PathZone& zone : zones)
+    connectPathZone(zone);
+  invalidateTopology();
+}
+
+// Zones left without any case are dropped. To keep ids matching their index in
+// `zones`, the last zone takes the slot of each removed one, and gets renumbered.
+void ZoneGrid::removeEmptyZones(QVector<unsigned int> emptied, QVector<unsigned int>& affected, QVector<unsigned int>& touched)
+{
+  std::sort(emptied.begin(), emptied.end(), std::greater<unsigned int>());
+  for (unsigned int id : qAsConst(emptied))
+  {
+    unsigned int lastId = static_cast<unsigned int>(zones.size());
+
+    affected.removeAll(id);
+    touched.removeAll(id);
+    if (id != lastId)
+    {
+      PathZone&    slot         = zones[static_cast<int>(id) - 1];
+      unsigned int slotRevision = slot.revision;
+
+      slot = zones.last();
+      slot.id = id;
+      slot.revision = std::max(slotRevision, slot.revision) + 1;
+      for (QPoint position : slot.positions)
+      {
+        auto* gridCase = getGridCase({position.x(), position.y(), slot.floor});
+
+        if (gridCase && gridCase->pathZone == lastId)
+          gridCase->pathZone = id;
+      }
+      // zones linked to the moved zone still point to its former slot
+      for (const PathZone::Connection& exit : qAsConst(slot.exits))
+        touched << exit.second->pathZone;
+      std::replace(affected.begin(), affected.end(), lastId, id);
+      std::replace(touched.begin(), touched.end(), lastId, id);
+      if (!affected.contains(id))
+        affected << id;
+    }
+    zones.removeLast();
+  }
+}
+
+// Rebuilds the zones of the cell containing `position`, after some of its
+// cases got connected or disconnected. On floors using the tilemap's
+// pathfinding zones, only the zone holding the position is rebuilt.
+// Zone ids stay stable: new zones reuse the slots of the ones they replace.
+void ZoneGrid::repartitionCell(Point position)
+{
+  LevelGrid::CaseContent*          origin = getGridCase(position);
+  LevelGrid*                       grid   = origin ? origin->grid : nullptr;
+  QVector<unsigned int>            affected;
+  QVector<LevelGrid::CaseContent*> cases;
+  QVector<PathZone>                freshZones;
+  QVector<unsigned int>            touched;
+  const PathZone*                  storage = zones.constData();
+
+  if (!grid)
+    return ;
+  if (grid->hasPathfindingZones())
+  {
+    if (origin->pathZone)
+    {
+      for (QPoint zonePosition : getPathZoneById(origin->pathZone)->positions)
+        cases.push_back(grid->getGridCase(zonePosition.x(), zonePosition.y()));
+    }
+    else if (origin->hasConnections())
+      cases.push_back(origin);
+  }
+  else
+    cases = getConnectedCases(grid, cellRect(cellOf(position, ZONE_GRANULARITY), ZONE_GRANULARITY));
+  if (origin->pathZone)
+    affected << origin->pathZone;
+  for (auto* gridCase : qAsConst(cases))
+  {
+    if (gridCase->pathZone && !affected.contains(gridCase->pathZone))
+      affected << gridCase->pathZone;
+  }
+  for (unsigned int id : qAsConst(affected))
+  {
+    PathZone& zone = zones[static_cast<int>(id) - 1];
+
+    for (auto it = zone.connections.keyBegin() ; it != zone.connections.keyEnd() ; ++it)
+      touched << (*it)->id;
+    for (QPoint zonePosition : zone.positions)
+    {
+      auto* gridCase = grid->getGridCase(zonePosition.x(), zonePosition.y());
+
+      if (gridCase && gridCase->pathZone == id)
+        gridCase->pathZone = 0;
+    }
+    zone.positions.clear();
+    zone.exits.clear();
+    zone.connections.clear();
+    zone.rect = QRect();
+    zone.revision++;
+  }
+  freshZones = partitioner.partition(cases);
+  for (int i = 0 ; i < freshZones.size() ; ++i)
+  {
+    PathZone& fresh = freshZones[i];
+
+    if (i < affected.size())
+    {
+      fresh.id = affected[i];
+      fresh.revision = zones[static_cast<int>(fresh.id) - 1].revision;
+      zones[static_cast<int>(fresh.id) - 1] = fresh;
+    }
+    else
+    {
+      fresh.id = static_cast<unsigned int>(zones.size()) + 1;
+      zones << fresh;
+      affected << fresh.id;
+    }
+    registerPathZone(zones[static_cast<int>(fresh.id) - 1]);
+  }
+  if (freshZones.size() < affected.size())
+    removeEmptyZones(affected.mid(freshZones.size()), affected, touched);
+  if (zones.constData() != storage)
+  {
+    // zones got reallocated: every connection must be rebuilt
+    for (PathZone& zone : zones)
+      connectPathZone(zone);
+  }
+  else
+  {
+    for (unsigned int id : qAsConst(affected))
+    {
+      PathZone& zone = zones[static_cast<int>(id) - 1];
+
+      connectPathZone(zone);
+      for (const PathZone::Connection& exit : zone.exits)
+        touched << exit.second->pathZone;
+    }
+    for (unsigned int id : qAsConst(touched))
+    {
+      PathZone* zone = getPathZoneById(id);
+
+      if (zone && !affected.contains(id))
+        connectPathZone(*zone);
+    }
   }
+  invalidateTopology();
 }
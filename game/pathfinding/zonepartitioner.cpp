@@ -0,0 +1,107 @@
+#include "zonepartitioner.h"
+#include <algorithm>
+
+static void detectZoneBoundaries(PathZone& zone)
+{
+  QPoint topLeft, bottomRight;
+  auto it = zone.positions.begin();
+
+  topLeft = bottomRight = *it;
+  while (++it != zone.positions.end())
+  {
+    if (it->x() < topLeft.x())
+      topLeft.setX(it->x());
+    if (it->y() < topLeft.y())
+      topLeft.setY(it->y());
+    if (it->x() > bottomRight.x())
+      bottomRight.setX(it->x());
+    if (it->y() > bottomRight.y())
+      bottomRight.setY(it->y());
+  }
+  zone.rect = QRect(topLeft, bottomRight);
+}
+
+void ZonePartitioner::reset(unsigned int caseCount)
+{
+  marks.assign(caseCount, 0);
+  stamp = 0;
+}
+
+unsigned int ZonePartitioner::nextStamp()
+{
+  if (++stamp == 0)
+  {
+    std::fill(marks.begin(), marks.end(), 0);
+    stamp = 1;
+  }
+  return stamp;
+}
+
+unsigned int ZonePartitioner::markOf(const LevelGrid::CaseContent& gridCase) const
+{
+  unsigned int key = gridCase.GetSearchKey();
+
+  return key < marks.size() ? marks[key] : 0;
+}
+
+void ZonePartitioner::mark(const LevelGrid::CaseContent& gridCase, unsigned int value)
+{
+  unsigned int key = gridCase.GetSearchKey();
+
+  if (key >= marks.size())
+    marks.resize(key + 1, 0);
+  marks[key] = value;
+}
+
+QVector<PathZone> ZonePartitioner::partition(const QVector<LevelGrid::CaseContent*>& cases)
+{
+  QVector<PathZone>                zoneList;
+  QVector<LevelGrid::CaseContent*> aggregatedCases;
+  unsigned int                     pending = nextStamp();
+
+  for (auto* gridCase : cases)
+    mark(*gridCase, pending);
+  for (auto* seed : cases)
+  {
+    PathZone     zone;
+    unsigned int zoneStamp;
+
+    if (markOf(*seed) != pending)
+      continue ;
+    // - flood-fill from the seed over the pending cases, marking them
+    //   as part of the zone as soon as they get queued
+    zoneStamp = nextStamp();
+    zone.floor = seed->position.z;
+    aggregatedCases.clear();
+    aggregatedCases.push_back(seed);
+    mark(*seed, zoneStamp);
+    for (int caseIt = 0 ; caseIt < aggregatedCases.size() ; ++caseIt)
+    {
+      aggregatedCases[caseIt]->eachConnection([&](const LevelGrid::CaseConnection& caseConnection)
+      {
+        if (markOf(*caseConnection.to) == pending)
+        {
+          mark(*caseConnection.to, zoneStamp);
+          aggregatedCases.push_back(caseConnection.to);
+        }
+      });
+    }
+
+    // - connections to cases that are not marked with the zone stamp
+    //   are registered as exits towards other zones
+    zone.positions.reserve(aggregatedCases.size());
+    for (auto* currentCase : qAsConst(aggregatedCases))
+    {
+      zone.positions.push_back(currentCase->position);
+      currentCase->eachConnection([&](const LevelGrid::CaseConnection& caseConnection)
+      {
+        if (markOf(*caseConnection.to) != zoneStamp)
+          zone.exits.push_back({currentCase, caseConnection.to});
+      });
+    }
+    detectZoneBoundaries(zone);
+    if (zone.positions.size() > 1 || zone.exits.size() > 0)
+      zoneList << zone;
+  }
+  return zoneList;
+}
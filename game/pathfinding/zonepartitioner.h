@@ -0,0 +1,26 @@
+#ifndef  ZONEPARTITIONER_H
+# define ZONEPARTITIONER_H
+
+# include <QVector>
+# include <vector>
+# include "pathzone.h"
+
+// Splits a set of cases into zones of connected cases, in time linear with the
+// number of cases and connections. Membership and visits are tracked in a table
+// indexed by search keys, stamped so that it never needs to be cleared between calls.
+class ZonePartitioner
+{
+public:
+  void              reset(unsigned int caseCount);
+  QVector<PathZone> partition(const QVector<LevelGrid::CaseContent*>& cases);
+
+private:
+  unsigned int nextStamp();
+  unsigned int markOf(const LevelGrid::CaseContent&) const;
+  void         mark(const LevelGrid::CaseContent&, unsigned int stamp);
+
+  std::vector<unsigned int> marks;
+  unsigned int              stamp = 0;
+};
+
+#endif // ZONEPARTITIONER_H
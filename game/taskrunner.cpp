@@ -4,6 +4,8 @@
 #include <QJsonArray>
 #include <QDebug>
 #include <cmath>
+#include <algorithm>
+#include <functional>
 
 bool shouldSaveTasks();
 
@@ -24,45 +26,45 @@ void TaskRunner::update(qint64 delta)
 {
   TaskUpdateLock updateLock(*this);
 
-  for (auto it = tasks.begin() ; it != tasks.end() ;)
+  currentTime += delta;
+  while (!scheduledTasks.isEmpty() && scheduledTasks.first().dueTime <= currentTime)
   {
-    auto elapsedTime = delta;
-
-    if (it->timeLeft <= elapsedTime)
+    ScheduledTask                  entry = scheduledTasks.first();
+    QHash<quint64, Task>::iterator it;
+    QString                        name;
+    int                            totalIterations;
+
+    std::pop_heap(scheduledTasks.begin(), scheduledTasks.end(), std::greater<ScheduledTask>());
+    scheduledTasks.removeLast();
+    it = tasks.find(entry.id);
+    if (it == tasks.end() || it->generation != entry.generation)
+      continue ;
+    totalIterations = 1 + static_cast<int>((currentTime - it->dueTime) / it->interval);
+    if (!it->infinite && totalIterations >= it->iterationCount)
+    {
+      totalIterations = it->iterationCount;
+      it->iterationCount = 0;
+    }
+    else if (!it->infinite)
+      it->iterationCount -= totalIterations;
+    it->dueTime += totalIterations * it->interval;
+    name = it->name;
+    // The script may add, remove or reschedule tasks: look the task up again afterwards
+    if (!runTask(name, totalIterations))
+      eraseTask(entry.id);
+    it = tasks.find(entry.id);
+    if (it != tasks.end() && it->generation == entry.generation)
     {
-      int totalIterations = 1;
-
-      elapsedTime -= it->timeLeft;
-      if (elapsedTime >= it->interval)
-      {
-        totalIterations += static_cast<int>(elapsedTime / it->interval);
-        it->timeLeft = elapsedTime % it->interval;
-      }
+      if (it->iterationCount == 0)
+        eraseTask(entry.id);
       else
-        it->timeLeft = it->interval - elapsedTime;
-      if (!it->infinite && totalIterations >= it->iterationCount)
-      {
-        totalIterations = it->iterationCount;
-        it->iterationCount = 0;
-      }
-      else if (!it->infinite)
-        it->iterationCount -= totalIterations;
-      if (!runTask(*it, totalIterations))
-        it->iterationCount = 0;
+        scheduleTask(entry.id, *it);
     }
-    else
-      it->timeLeft -= elapsedTime;
-    if (it->iterationCount == 0)
-      it = tasks.erase(it);
-    else
-      it++;
   }
-  for (const Task& task : pendingAdditions)
-    tasks << task;
-  pendingAdditions.clear();
+  compactSchedule();
 }
 
-bool TaskRunner::runTask(Task& task, int iterations)
+bool TaskRunner::runTask(const QString& name, int iterations)
 {
   if (script)
   {
@@ -70,7 +72,7 @@ bool TaskRunner::runTask(Task& task, int iterations)
     QJSValueList args;
 
     args << iterations;
-    script->call(task.name, args);
+    script->call(name, args);
     return retval.isBool() ? retval.toBool() : true;
   }
   else
@@ -78,25 +80,57 @@ bool TaskRunner::runTask(Task& task, int iterations)
   return false;
 }
 
-bool TaskRunner::hasTask(const QString &name)
+void TaskRunner::scheduleTask(quint64 id, const Task& task)
+{
+  scheduledTasks.push_back(ScheduledTask{task.dueTime, id, task.generation});
+  std::push_heap(scheduledTasks.begin(), scheduledTasks.end(), std::greater<ScheduledTask>());
+}
+
+void TaskRunner::eraseTask(quint64 id)
 {
-  for (auto it = tasks.begin() ; it != tasks.end() ; ++it)
+  auto it = tasks.find(id);
+
+  if (it != tasks.end())
   {
-    if (it->name == name)
-      return true;
+    auto ids = taskIds.find(it->name);
+
+    if (ids != taskIds.end())
+    {
+      ids->removeOne(id);
+      if (ids->isEmpty())
+        taskIds.erase(ids);
+    }
+    tasks.erase(it);
   }
-  return false;
+}
+
+// Drops the stale entries once they outnumber the live ones
+void TaskRunner::compactSchedule()
+{
+  if (scheduledTasks.size() > tasks.size() * 2 + 32)
+  {
+    scheduledTasks.clear();
+    for (auto it = tasks.begin() ; it != tasks.end() ; ++it)
+      scheduledTasks.push_back(ScheduledTask{it->dueTime, it.key(), it->generation});
+    std::make_heap(scheduledTasks.begin(), scheduledTasks.end(), std::greater<ScheduledTask>());
+  }
+}
+
+bool TaskRunner::hasTask(const QString &name)
+{
+  return taskIds.contains(name);
 }
 
 void TaskRunner::addTask(const QString &name, qint64 interval, int iterationCount)
 {
   if (interval > 0)
   {
-    Task task;
+    quint64 id = nextTaskId++;
+    Task    task;
 
     task.name = name;
     task.interval = interval;
-    task.timeLeft = interval;
+    task.dueTime = currentTime + interval;
     if (iterationCount < 1)
     {
       task.infinite = true;
@@ -104,10 +138,9 @@ void TaskRunner::addTask(const QString &name, qint64 interval, int iterationCoun
     }
     else
       task.iterationCount = iterationCount;
-    if (!updating)
-      tasks << task;
-    else
-      pendingAdditions << task;
+    tasks.insert(id, task);
+    taskIds[name] << id;
+    scheduleTask(id, task);
   }
   else
     qDebug() << "/!\\ Tried to add task" << name << "with interval=0";
@@ -123,13 +156,10 @@ bool TaskRunner::removeTask(const QString &name)
 {
   if (!updating)
   {
-    for (auto it = tasks.begin() ; it != tasks.end() ;)
-    {
-      if (it->name == name)
-        it = tasks.erase(it);
-      else
-        ++it;
-    }
+    const QList<quint64> ids = taskIds.take(name);
+
+    for (quint64 id : ids)
+      tasks.remove(id);
     return true;
   }
   return false;
@@ -137,29 +167,30 @@ bool TaskRunner::removeTask(const QString &name)
 
 void TaskRunner::decreaseIterationsFor(const QString &name, int iterationCount)
 {
-  for (auto it = tasks.begin() ; it != tasks.end() ;)
+  const QList<quint64> ids = taskIds.value(name);
+
+  for (quint64 id : ids)
   {
-    if (it->name == name)
+    Task& task = tasks[id];
+
+    if (task.iterationCount > iterationCount)
     {
-      if (it->iterationCount > iterationCount)
-      {
-        it->iterationCount -= iterationCount;
-        it->timeLeft = it->interval;
-        break ;
-      }
-      else if (it->iterationCount == iterationCount)
-      {
-        tasks.erase(it);
-        break ;
-      }
-      else
-      {
-        iterationCount -= it->iterationCount;
-        it = tasks.erase(it);
-      }
+      task.iterationCount -= iterationCount;
+      task.dueTime = currentTime + task.interval;
+      task.generation++;
+      scheduleTask(id, task);
+      break ;
+    }
+    else if (task.iterationCount == iterationCount)
+    {
+      eraseTask(id);
+      break ;
     }
     else
-      ++it;
+    {
+      iterationCount -= task.iterationCount;
+      eraseTask(id);
+    }
   }
 }
 
@@ -168,14 +199,17 @@ void TaskRunner::load(const QJsonObject& data)
   for (auto jvalue : data["tasks"].toArray())
   {
     QJsonObject taskData(jvalue.toObject());
-    Task task;
+    quint64     id = nextTaskId++;
+    Task        task;
 
     task.name           = taskData["name"].toString();
     task.iterationCount = taskData["count"].toInt();
     task.interval       = taskData["interval"].toInt();
     task.infinite       = taskData["infinite"].toBool();
-    task.timeLeft       = taskData["timeLeft"].toInt();
-    tasks << task;
+    task.dueTime        = currentTime + taskData["timeLeft"].toInt();
+    tasks.insert(id, task);
+    taskIds[task.name] << id;
+    scheduleTask(id, task);
   }
 }
 
@@ -183,17 +217,20 @@ void TaskRunner::save(QJsonObject& data) const
 {
   if (shouldSaveTasks())
   {
-    QJsonArray array;
+    QJsonArray     array;
+    QList<quint64> ids = tasks.keys();
 
-    for (const auto& task : tasks)
+    std::sort(ids.begin(), ids.end());
+    for (quint64 id : qAsConst(ids))
     {
+      const Task task = tasks.value(id);
       QJsonObject taskData;
 
       taskData["name"]     = task.name;
       taskData["count"]    = task.iterationCount;
       taskData["infinite"] = task.infinite;
       taskData["interval"] = task.interval;
-      taskData["timeLeft"] = task.timeLeft;
+      taskData["timeLeft"] = task.dueTime - currentTime;
       array << taskData;
     }
     data["tasks"] = array;
@@ -4,10 +4,14 @@
 # include <QObject>
 # include <QJSValue>
 # include <QJsonObject>
+# include <QHash>
+# include <QVector>
 # include "scriptcontroller.h"
 
 struct TaskUpdateLock;
 
+// Tasks are kept in a min-heap ordered by due time, on a clock local to the runner,
+// so that updates only cost as much as the tasks that are actually due.
 class TaskRunner : public QObject
 {
   Q_OBJECT
@@ -20,7 +24,19 @@ class TaskRunner : public QObject
     int         iterationCount = 1;
     bool        infinite = false;
     qint64      interval;
-    qint64      timeLeft;
+    qint64      dueTime;
+    quint32     generation = 0;
+  };
+
+  // Heap entries go stale when their task is removed or rescheduled: they are
+  // skipped when they reach the top, instead of being searched for.
+  struct ScheduledTask
+  {
+    qint64      dueTime;
+    quint64     id;
+    quint32     generation;
+
+    bool operator>(const ScheduledTask& other) const { return dueTime != other.dueTime ? dueTime > other.dueTime : id > other.id; }
   };
 
 public:
@@ -42,10 +58,17 @@ public:
 signals:
 
 private:
-  bool runTask(Task&, int iterations);
+  bool runTask(const QString& name, int iterations);
+  void scheduleTask(quint64 id, const Task&);
+  void eraseTask(quint64 id);
+  void compactSchedule();
 
   bool updating = false;
-  QList<Task> tasks, pendingAdditions;
+  qint64 currentTime = 0;
+  quint64 nextTaskId = 0;
+  QHash<quint64, Task> tasks;
+  QHash<QString, QList<quint64>> taskIds;
+  QVector<ScheduledTask> scheduledTasks;
   ScriptController* script = nullptr;
 };
 
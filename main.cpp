@@ -13,6 +13,7 @@
 #include "tilemap/tilelayer.h"
 #include "tilemap/tilezone.h"
 #include "tilemap/tile.h"
+#include "tilemap/tilelayeritem.h"
 
 #include "game.h"
 #include "game/dices.hpp"
@@ -32,6 +33,8 @@
 #include "game/gamepadcontroller.h"
 #include "game/savepreview.h"
 #include "game/diplomacy.hpp"
+#include "game/level/prerenderchunks.h"
+#include "game/level/prerenderimageprovider.h"
 
 #include "cmap/statmodel.h"
 
@@ -47,8 +50,9 @@ QJSEngine* qmlJsEngine = nullptr;
 void registerQmlTilemap() {
   qmlRegisterType<TileMap>  ("Tiles", 1,0, "TileMap");
   qmlRegisterType<TileLayer>("Tiles", 1,0, "TileLayer");
-  qmlRegisterType<Tile>     ("Tiles", 1,0, "Tile");
+  qRegisterMetaType<Tile>();
   qmlRegisterType<TileZone> ("Tiles", 1,0, "TileZone");
+  qmlRegisterType<TileLayerItem>("Tiles", 1,0, "TileLayerItem");
 }
 
 int main(int argc, char *argv[])
@@ -118,6 +122,7 @@ int main(int argc, char *argv[])
   qmlRegisterType<ObjectGroup>("Game", 1,0, "ObjectGroup");
   qmlRegisterType<Credits>("Game", 1,0, "Credits");
   qmlRegisterType<CreditPerson>("Game", 1,0, "Person");
+  qmlRegisterType<PreRenderChunkModel>("Game", 1,0, "PreRenderChunkModel");
 
   qRegisterMetaType<Character*>("const Character*");
   qRegisterMetaType<CharacterDiplomacy*>("const CharacterDiplomacy*");
@@ -143,6 +148,7 @@ int main(int argc, char *argv[])
   I18n*         i18n = new I18n(&app);
 
   qmlJsEngine = &engine;
+  engine.addImageProvider("prerender", new PreRenderImageProvider);
   engine.rootContext()->setContextProperty("i18n", i18n);
   engine.rootContext()->setContextProperty("gameManager", gameManager);
   engine.rootContext()->setContextProperty("musicManager", musicManager);
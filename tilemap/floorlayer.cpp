@@ -1,6 +1,7 @@
 #include "floorlayer.h"
 #include "tilemap.h"
 #include <QJsonArray>
+#include <QCryptographicHash>
 
 FloorLayer::FloorLayer(QObject *parent) : TileLayer(parent)
 {
@@ -33,9 +34,9 @@ void FloorLayer::load(const QJsonObject& object, const TileMap* parent)
     {
       for (TileLayer* layer : allLayers)
       {
-        if (layer->getTile(x, y) != nullptr && !layer->getName().startsWith("wall"))
+        if (layer->isInside(x, y) && !layer->getName().startsWith("wall"))
         {
-          tiles[y * size.width() + x] = &dummyTile;
+          tiles[y * size.width() + x] = TileCell{1, placeholderSlot};
           break ;
         }
       }
@@ -49,3 +50,15 @@ void FloorLayer::renderToImage(QImage& image, QPoint)
 
   tilemap->renderToImage(image,  this->offset + floorsOffset);
 }
+
+QByteArray FloorLayer::getContentHash() const
+{
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+
+  hash.addData(TileLayer::getContentHash());
+  for (const TileLayer* layer : tilemap->getLayers())
+    hash.addData(layer->getContentHash());
+  for (const TileLayer* layer : tilemap->getRoofs())
+    hash.addData(layer->getContentHash());
+  return hash.result();
+}
@@ -16,11 +16,11 @@ public:
   TileMap* getTileMap() const { return tilemap; }
 
   void renderToImage(QImage& image, QPoint) override;
+  QByteArray getContentHash() const override;
 
 private:
   unsigned char floor;
   TileMap*      tilemap;
-  Tile          dummyTile;
 };
 
 #endif // FLOORLAYER_H
@@ -0,0 +1,120 @@
+#include "lightlayer.h"
+#include "tileset.h"
+#include <algorithm>
+
+// Parts of the lights tileset, by order of precedence for the cell stored in the layer
+static const int partPrecedence[9] = {4, 1, 3, 5, 7, 0, 2, 6, 8};
+
+static int stampPartAt(QRect rect, int x, int y)
+{
+  int column = x == rect.left() ? 0 : (x == rect.right()  ? 2 : 1);
+  int row    = y == rect.top()  ? 0 : (y == rect.bottom() ? 2 : 1);
+
+  return row * 3 + column;
+}
+
+LightLayer::LightLayer(const Tileset* tileset, QObject* parent) : TileLayer(parent), tileset(tileset)
+{
+  name = "dynamic-lights";
+}
+
+void LightLayer::setLight(QObject* source, QPoint position, int radius)
+{
+  auto  it = stamps.find(source);
+  Stamp stamp{position, radius};
+  QRect updatedRect = stamp.getRect();
+
+  if (it != stamps.end())
+  {
+    if (it->position == position && it->radius == radius)
+      return ;
+    applyStamp(*it, -1);
+    updatedRect = updatedRect.united(it->getRect());
+    *it = stamp;
+  }
+  else
+    stamps.insert(source, stamp);
+  applyStamp(stamp, 1);
+  refreshCases(updatedRect);
+}
+
+void LightLayer::removeLight(QObject* source)
+{
+  auto it = stamps.find(source);
+
+  if (it != stamps.end())
+  {
+    QRect rect = it->getRect();
+
+    applyStamp(*it, -1);
+    stamps.erase(it);
+    refreshCases(rect);
+  }
+}
+
+void LightLayer::appendTilesAt(int x, int y, QVector<Tile>& tiles) const
+{
+  auto it = coverage.constFind(y * size.width() + x);
+
+  if (it != coverage.constEnd())
+  {
+    for (int part = 0 ; part < 9 ; ++part)
+    {
+      for (int i = 0 ; i < it->parts[part] ; ++i)
+        tiles << Tile(tileset, tileset->getFirstGid() + part, QPoint(x, y), offset);
+    }
+  }
+}
+
+void LightLayer::applyStamp(const Stamp& stamp, int delta)
+{
+  QRect rect = stamp.getRect();
+  QRect cases = rect.intersected(QRect(QPoint(0, 0), size));
+
+  for (int y = cases.top() ; y <= cases.bottom() ; ++y)
+  {
+    for (int x = cases.left() ; x <= cases.right() ; ++x)
+    {
+      int       index = y * size.width() + x;
+      Coverage& entry = coverage[index];
+      quint8&   count = entry.parts[stampPartAt(rect, x, y)];
+
+      count = static_cast<quint8>(count + delta);
+      if (std::all_of(std::begin(entry.parts), std::end(entry.parts), [](quint8 value) { return value == 0; }))
+        coverage.remove(index);
+    }
+  }
+}
+
+void LightLayer::refreshCases(QRect rect)
+{
+  QRect cases = rect.intersected(QRect(QPoint(0, 0), size));
+
+  for (int y = cases.top() ; y <= cases.bottom() ; ++y)
+  {
+    for (int x = cases.left() ; x <= cases.right() ; ++x)
+    {
+      auto it = coverage.constFind(y * size.width() + x);
+      int  part = -1;
+
+      if (it != coverage.constEnd())
+      {
+        for (int candidate : partPrecedence)
+        {
+          if (it->parts[candidate] > 0)
+          {
+            part = candidate;
+            break ;
+          }
+        }
+      }
+      if (part >= 0)
+        setCellAt(x, y, tileset, tileset->getFirstGid() + part);
+      else
+        setCellAt(x, y, nullptr, 0);
+    }
+  }
+  dirtyRenderRect = dirtyRenderSize = true;
+  emit regionChanged(cases);
+  emit tilesChanged();
+}
@@ -0,0 +1,43 @@
+#ifndef  LIGHTLAYER_H
+# define LIGHTLAYER_H
+
+# include "tilelayer.h"
+
+// Merges the light zones of a floor's light sources into a single layer.
+// Each source is only kept as a stamp (position and radius): moving it updates
+// the coverage of the cases it leaves and enters, and nothing else. Overlapping
+// stamps are all drawn, so that their light adds up like separate layers did.
+class LightLayer : public TileLayer
+{
+  Q_OBJECT
+
+  struct Stamp
+  {
+    QPoint position;
+    int    radius;
+
+    QRect  getRect() const { return QRect(position.x() - radius, position.y() - radius, radius * 2 + 1, radius * 2 + 1); }
+  };
+
+  // How many stamps cover a case with each of the 9 parts of the lights tileset
+  struct Coverage
+  {
+    quint8 parts[9] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+  };
+public:
+  explicit LightLayer(const Tileset* tileset, QObject* parent = nullptr);
+
+  void setLight(QObject* source, QPoint position, int radius);
+  void removeLight(QObject* source);
+  void appendTilesAt(int x, int y, QVector<Tile>& tiles) const override;
+
+private:
+  void applyStamp(const Stamp&, int delta);
+  void refreshCases(QRect);
+
+  const Tileset*         tileset;
+  QHash<QObject*, Stamp> stamps;
+  QHash<int, Coverage>   coverage;
+};
+
+#endif // LIGHTLAYER_H
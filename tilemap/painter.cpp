@@ -4,17 +4,17 @@
 struct TileRenderFunctor
 {
   QPainter& painter;
-  Tile*     tile;
+  Tile      tile;
   QPoint    position, renderOffset;
   QSize     tileSize;
 
   void operator()()
   {
-    QRect  renderRect = tile->getRenderRect();
-    QPoint relativePos(position - QPoint(0, tile->getRect().height() - tileSize.height()));
-    QRect  relativeRect(relativePos - renderOffset, renderRect.size());
+    QRect  clipRect = tile.getRect();
+    QPoint relativePos(position - QPoint(0, clipRect.height() - tileSize.height()));
+    QRect  relativeRect(relativePos - renderOffset, clipRect.size());
 
-    painter.drawImage(relativeRect, tile->getTexture(), tile->getRect());
+    painter.drawImage(relativeRect, tile.getTexture(), clipRect);
   }
 };
 
@@ -31,12 +31,12 @@ static void renderTilemapWalls(TileMap& tilemap, QImage& image, QPoint renderOff
   {
     for (int y = 0 ; y < mapSize.height() ; ++y)
     {
-      Tile* block = blocks ? blocks->getTile(x, y) : nullptr;
-      Tile* vwall = vwalls ? vwalls->getTile(x, y) : nullptr;
-      Tile* hwall = hwalls ? hwalls->getTile(x, y) : nullptr;
+      Tile block = blocks ? blocks->getTile(x, y) : Tile();
+      Tile vwall = vwalls ? vwalls->getTile(x, y) : Tile();
+      Tile hwall = hwalls ? hwalls->getTile(x, y) : Tile();
       QPoint position(tilemap.getPointFor(x, y));
 
-      for (Tile* tile : QVector<Tile*>{block, vwall, hwall})
+      for (const Tile& tile : {block, vwall, hwall})
       {
         if (tile)
           TileRenderFunctor{painter, tile, position, renderOffset, tilemap.getTileSize()}();
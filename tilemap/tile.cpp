@@ -1,7 +1,7 @@
 #include "tile.h"
 #include "tileset.h"
 
-static QPoint makeRenderPosition(QPoint offset, QPoint currentPosition, QSize tileSize)
+QPoint Tile::makeRenderPosition(QPoint offset, QPoint currentPosition, QSize tileSize)
 {
   return QPoint(
     offset.x() + currentPosition.x() * tileSize.width()  / 2 - currentPosition.y() * tileSize.width()  / 2,
@@ -9,20 +9,31 @@ static QPoint makeRenderPosition(QPoint offset, QPoint currentPosition, QSize ti
   );
 }
 
-Tile::Tile(QObject *parent) : QObject(parent), image(nullptr), tileset(nullptr)
+Tile::Tile(const Tileset* tileset, int tid, QPoint position, QPoint offset) :
+  tid(tid), tileset(tileset), position(position), offset(offset)
 {
+}
+
+const QImage& Tile::getTexture() const
+{
+  static const QImage emptyTexture;
+
+  return tileset ? tileset->getImage() : emptyTexture;
+}
 
+QString Tile::getImage() const
+{
+  return tileset ? tileset->getSource() : QString();
+}
+
+QRect Tile::getRect() const
+{
+  return tileset ? tileset->getClipRectFor(tid) : QRect();
 }
 
-void Tile::prepare(QPoint offset, const Tileset* tileset, int tid, QPoint position)
+QPoint Tile::getRenderPosition() const
 {
-  this->tileset = tileset;
-  this->tid = tid;
-  setTexture(&(tileset->getImage()));
-  setImage(&tileset->getSource());
-  setPosition(position);
-  setRect(tileset->getClipRectFor(tid));
-  setRenderPosition(makeRenderPosition(offset, position, tileset->getTileSize()));
+  return tileset ? makeRenderPosition(offset, position, tileset->getTileSize()) : QPoint();
 }
 
 QVariant Tile::getProperty(const QByteArray &name) const
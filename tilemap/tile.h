@@ -3,42 +3,46 @@
 
 # include <QObject>
 # include <QRect>
+# include <QImage>
+# include <QMetaType>
 
 class Tileset;
 
-class Tile : public QObject
+// Tiles aren't stored: layers keep packed cells, and a Tile is built on demand
+// from a cell when something needs to look at it.
+class Tile
 {
-  Q_OBJECT
+  Q_GADGET
 
-  Q_PROPERTY(QString image          READ getImage         CONSTANT)
-  Q_PROPERTY(QRect   clippedRect    MEMBER rect           CONSTANT)
-  Q_PROPERTY(QPoint  position       MEMBER position       CONSTANT)
-  Q_PROPERTY(QPoint  renderPosition MEMBER renderPosition CONSTANT)
+  Q_PROPERTY(QString image          READ getImage          CONSTANT)
+  Q_PROPERTY(QRect   clippedRect    READ getRect           CONSTANT)
+  Q_PROPERTY(QPoint  position       READ getPosition       CONSTANT)
+  Q_PROPERTY(QPoint  renderPosition READ getRenderPosition CONSTANT)
 public:
-  explicit Tile(QObject* parent = nullptr);
-
-  void prepare(QPoint offset, const Tileset*, int tid, QPoint position);
-  void setRect(const QRect& value) { rect = value; }
-  void setPosition(const QPoint& value) { position = value; }
-  void setRenderPosition(const QPoint& value) { renderPosition = value; }
-  void setImage(const QString* value) { image = value; }
-  void setTexture(const QImage* value) { texture = value; }
-  inline const QImage& getTexture() const { return *texture; }
-  inline const QString& getImage() const { return *image; }
-  inline const QRect& getRect() const { return rect; }
+  Tile() {}
+  Tile(const Tileset*, int tid, QPoint position, QPoint offset);
+
+  static QPoint makeRenderPosition(QPoint offset, QPoint position, QSize tileSize);
+
+  bool isNull() const { return tid <= 0; }
+  explicit operator bool() const { return !isNull(); }
+  int getTid() const { return tid; }
+  const Tileset* getTileset() const { return tileset; }
+  const QImage& getTexture() const;
+  QString getImage() const;
+  QRect getRect() const;
   inline const QPoint& getPosition() const { return position; }
-  inline const QPoint& getRenderPosition() const { return renderPosition; }
-  inline QRect getRenderRect() const { return QRect(renderPosition, rect.size()); }
+  QPoint getRenderPosition() const;
+  QRect getRenderRect() const { return QRect(getRenderPosition(), getRect().size()); }
   QVariant getProperty(const QByteArray& name) const;
 
 private:
   int            tid = 0;
-  const QString* image = nullptr;
-  const QImage*  texture;
-  const Tileset* tileset;
-  QRect          rect;
+  const Tileset* tileset = nullptr;
   QPoint         position;
-  QPoint         renderPosition;
+  QPoint         offset;
 };
 
+Q_DECLARE_METATYPE(Tile)
+
 #endif // TILE_H
@@ -5,6 +5,9 @@
 #include <QPainter>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QCryptographicHash>
+#include <QFileInfo>
+#include <QDateTime>
 #include <QDebug>
 
 TileLayer::TileLayer(QObject *parent) : TileMask(parent)
@@ -34,41 +37,56 @@ void TileLayer::load(const QJsonObject& object, const QVector<Tileset*>& tileset
 void TileLayer::initialize(QSize size)
 {
   this->size = size;
-  tiles.fill(nullptr, size.width() * size.height());
+  tiles.fill(TileCell{0, 0}, size.width() * size.height());
   dirtyRenderRect = dirtyRenderSize = true;
+  emit regionChanged(QRect(QPoint(0, 0), size));
 }
 
 void TileLayer::clear()
 {
-  for (auto it = tiles.begin() ; it != tiles.end() ; ++it)
-  {
-    Tile* tile = *it;
+  tiles.fill(TileCell{0, 0});
+  dirtyRenderRect = dirtyRenderSize = true;
+  emit regionChanged(QRect(QPoint(0, 0), size));
+}
+
+quint32 TileLayer::slotFor(const Tileset* tileset)
+{
+  int slot = tilesets.indexOf(tileset);
 
-    if (tile != nullptr)
+  if (slot < 0)
+  {
+    slot = tilesets.size();
+    if (static_cast<quint32>(slot) >= placeholderSlot)
     {
-      tile->deleteLater();
-      *it = nullptr;
+      qDebug() << "TileLayer:" << name << ": too many tilesets";
+      return placeholderSlot;
     }
+    tilesets.push_back(tileset);
   }
-  dirtyRenderRect = dirtyRenderSize = true;
+  return static_cast<quint32>(slot);
+}
+
+void TileLayer::setCell(TileCell& cell, const Tileset* tileset, int tileId)
+{
+  if (tileset && tileId > 0)
+  {
+    cell.gid  = static_cast<quint32>(tileId);
+    cell.slot = slotFor(tileset);
+  }
+  else
+    cell = TileCell{0, 0};
 }
 
 void TileLayer::fill(Tileset* tileset, int tileId)
 {
   if (tileset && tileId > 0)
   {
-    for (auto it = tiles.begin() ; it != tiles.end() ; ++it)
-    {
-      Tile* tile = *it;
+    TileCell cell;
 
-      if (!tile)
-      {
-        tile = new Tile(this);
-        *it = tile;
-      }
-      tile->prepare(offset, tileset, tileId, tile->getPosition());
-    }
+    setCell(cell, tileset, tileId);
+    tiles.fill(cell);
     dirtyRenderRect = dirtyRenderSize = true;
+    emit regionChanged(QRect(QPoint(0, 0), size));
   }
   else
     clear();
@@ -79,48 +97,34 @@ void TileLayer::fill(QRect rect, Tileset *tileset, int tileId)
   for (int x = rect.x() ; x <= rect.right() ; ++x)
   {
     for (int y = rect.y() ; y <= rect.bottom() ; ++y)
-      setTileIdAt(x, y, tileset, tileId);
+      setCellAt(x, y, tileset, tileId);
   }
+  dirtyRenderRect = dirtyRenderSize = true;
+  emit regionChanged(rect);
 }
 
 void TileLayer::setTileIdAt(int x, int y, Tileset *tileset, int tileId)
+{
+  setCellAt(x, y, tileset, tileId);
+  dirtyRenderRect = dirtyRenderSize = true;
+  emit regionChanged(QRect(x, y, 1, 1));
+}
+
+void TileLayer::setCellAt(int x, int y, const Tileset* tileset, int tileId)
 {
   int position = y * size.width() + x;
 
   if (position < tiles.count() && x >= 0 && y >= 0)
-  {
-    Tile* tile = tiles.at(position);
-
-    if (tile && (tileset == nullptr || tileId <= 0))
-    {
-      tile->deleteLater();
-      tiles[position] = nullptr;
-    }
-    else if (tileId > 0 && tileset)
-    {
-      QPoint coordinates(x, y);
-
-      if (!tile)
-      {
-        tile = new Tile(this);
-        tile->setPosition(coordinates);
-        tiles[position] = tile;
-      }
-      tile->prepare(offset, tileset, tileId, coordinates);
-    }
-  }
-  dirtyRenderRect = dirtyRenderSize = true;
+    setCell(tiles[position], tileset, tileId);
 }
 
 void TileLayer::loadTiles(const QJsonArray& tileArray, const QVector<Tileset*>& tilesets)
 {
-  QPoint currentPosition(0, 0);
-
   tiles.reserve(tileArray.size());
   for (const QJsonValue& value : qAsConst(tileArray))
   {
-    int tid = value.toInt();
-    bool success = false;
+    int      tid = value.toInt();
+    TileCell cell{0, 0};
 
     if (tid > 0)
     {
@@ -128,54 +132,61 @@ void TileLayer::loadTiles(const QJsonArray& tileArray, const QVector<Tileset*>&
       {
         if (tileset->isInRange(tid))
         {
-          Tile* tile = new Tile(this);
-
-          tile->prepare(offset, tileset, tid, currentPosition);
-          tiles.push_back(tile);
-          success = true;
+          setCell(cell, tileset, tid);
           break ;
         }
       }
     }
-    if (!success)
-      tiles.push_back(nullptr);
-    if (currentPosition.x() >= size.width() - 1)
-    {
-      currentPosition.setX(0);
-      currentPosition.ry()++;
-    }
-    else
-      currentPosition.rx()++;
+    tiles.push_back(cell);
   }
 }
 
-Tile* TileLayer::getTile(int x, int y) const
+Tile TileLayer::getTile(int x, int y) const
 {
   int position = y * size.width() + x;
 
-  if (position >= tiles.count() || x < 0 || y < 0)
-    return nullptr;
-  return tiles.at(position);
+  if (position < tiles.count() && x >= 0 && y >= 0 && x < size.width())
+  {
+    const TileCell& cell = tiles.at(position);
+
+    if (cell.gid > 0)
+    {
+      const Tileset* tileset = cell.slot != placeholderSlot ? tilesets.at(static_cast<int>(cell.slot)) : nullptr;
+
+      return Tile(tileset, static_cast<int>(cell.gid), QPoint(x, y), offset);
+    }
+  }
+  return Tile();
 }
 
-bool TileLayer::isInside(int x, int y) const
+// Every tile drawn on a case, from bottom to top
+void TileLayer::appendTilesAt(int x, int y, QVector<Tile>& result) const
 {
-  return getTile(x, y) != nullptr;
+  Tile tile = getTile(x, y);
+
+  if (tile)
+    result << tile;
 }
 
-int TileLayer::tilePropertyListCount(QQmlListProperty<Tile>* source)
+QVariant TileLayer::getQmlTile(int x, int y) const
 {
-  return reinterpret_cast<TileLayer*>(source->object)->tiles.size();
+  Tile tile = getTile(x, y);
+
+  return tile ? QVariant::fromValue(tile) : QVariant();
 }
 
-Tile* TileLayer::tilePropertyListAt(QQmlListProperty<Tile>* source, int index)
+bool TileLayer::isInside(int x, int y) const
 {
-  return reinterpret_cast<TileLayer*>(source->object)->tiles.at(index);
+  int position = y * size.width() + x;
+
+  return position < tiles.count() && x >= 0 && y >= 0 && x < size.width() && tiles.at(position).gid > 0;
 }
 
-QQmlListProperty<Tile> TileLayer::getQmlTiles()
+TileLayerModel* TileLayer::getTilesModel()
 {
-  return QQmlListProperty<Tile>(this, this, &TileLayer::tilePropertyListCount, &TileLayer::tilePropertyListAt);
+  if (!tilesModel)
+    tilesModel = new TileLayerModel(this);
+  return tilesModel;
 }
 
 QRect TileLayer::getRenderedRect()
@@ -204,11 +215,11 @@ void TileLayer::prepareRenderRect()
     {
       for (int y = 0 ; y < size.height() ; ++y)
       {
-        Tile* tile = getTile(x, y);
+        Tile tile = getTile(x, y);
 
         if (tile)
         {
-          QRect renderRect = tile->getRenderRect();
+          QRect renderRect = tile.getRenderRect();
 
           /*
           if (!hasInitializedLimits)
@@ -249,11 +260,11 @@ void TileLayer::prepareRenderSize()
     {
       for (int y = 0 ; y < size.height() ; ++y)
       {
-        Tile* tile = getTile(x, y);
+        Tile tile = getTile(x, y);
 
         if (tile)
         {
-          QRect renderRect = tile->getRenderRect();
+          QRect renderRect = tile.getRenderRect();
 
           if (min.x() > renderRect.topLeft().x())
             min.setX(renderRect.topLeft().x());
@@ -273,6 +284,26 @@ void TileLayer::prepareRenderSize()
   dirtyRenderSize = false;
 }
 
+// Identifies what the layer renders, including the tileset images it draws from
+QByteArray TileLayer::getContentHash() const
+{
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+
+  hash.addData(name.toUtf8());
+  hash.addData(QString("%1x%2+%3+%4").arg(size.width()).arg(size.height()).arg(offset.x()).arg(offset.y()).toUtf8());
+  hash.addData(color.name(QColor::HexArgb).toUtf8());
+  hash.addData(reinterpret_cast<const char*>(tiles.constData()), tiles.size() * static_cast<int>(sizeof(TileCell)));
+  for (const Tileset* tileset : tilesets)
+  {
+    QFileInfo source(tileset->getSource());
+
+    hash.addData(source.filePath().toUtf8());
+    hash.addData(QByteArray::number(source.size()));
+    hash.addData(QByteArray::number(source.lastModified().toMSecsSinceEpoch()));
+  }
+  return hash.result();
+}
+
 void TileLayer::renderToFile(const QString& fileName)
 {
   QRect    renderedRect(getRenderedRect());
@@ -294,14 +325,16 @@ void TileLayer::renderToImage(QImage &image, QPoint offset)
   {
     for (int y = 0 ; y < size.height() ; ++y)
     {
-      Tile* tile = getTile(x, y);
+      Tile tile = getTile(x, y);
 
       if (tile)
       {
-        QRect renderRect = tile->getRenderRect();
+        QRect renderRect = tile.getRenderRect();
         QRect relativeRect(renderRect.topLeft() - offset, renderRect.size());
 
-        painter.drawImage(relativeRect, tile->getTexture(), tile->getRect());
+        if (!relativeRect.intersects(image.rect()))
+          continue ;
+        painter.drawImage(relativeRect, tile.getTexture(), tile.getRect());
       }
     }
   }
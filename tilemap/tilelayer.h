@@ -7,8 +7,8 @@
 # include <QPoint>
 # include <QColor>
 # include <QVector>
-# include <QQmlListProperty>
 # include "tile.h"
+# include "tilelayermodel.h"
 
 class QJsonObject;
 class QJsonArray;
@@ -25,8 +25,17 @@ class TileLayer : public TileMask
   Q_PROPERTY(QColor  color   MEMBER color)
   Q_PROPERTY(bool    visible MEMBER visible NOTIFY visibleChanged)
   Q_PROPERTY(bool    prerendered MEMBER prerendered CONSTANT)
-  Q_PROPERTY(QQmlListProperty<Tile> tiles READ getQmlTiles NOTIFY tilesChanged)
+  Q_PROPERTY(TileLayerModel* tiles READ getTilesModel CONSTANT)
 public:
+  // Cells pack a tile's gid with the slot of its tileset in the layer's own tileset table
+  struct TileCell
+  {
+    quint32 gid  : 24;
+    quint32 slot : 8;
+  };
+
+  static const quint32 placeholderSlot = 0xFF;
+
   explicit TileLayer(QObject *parent = nullptr);
 
   void load(const QJsonObject&, const QVector<Tileset*>& tilesets);
@@ -37,9 +46,14 @@ public:
   bool isVisible() const { return visible; }
   void renderToFile(const QString& file);
   virtual void renderToImage(QImage& image, QPoint offset);
+  virtual QByteArray getContentHash() const;
   TileLayer* getMaskLayer() const;
 
-  Q_INVOKABLE Tile* getTile(int x, int y) const;
+  Tile getTile(int x, int y) const;
+  virtual void appendTilesAt(int x, int y, QVector<Tile>& tiles) const;
+  Q_INVOKABLE QVariant getQmlTile(int x, int y) const;
+  int  getCellCount() const { return tiles.size(); }
+  bool isCellEmpty(int index) const { return tiles.at(index).gid == 0; }
   Q_INVOKABLE QSize getRenderedSize();
   Q_INVOKABLE QRect getRenderedRect();
   Q_INVOKABLE bool isInside(int x, int y) const override;
@@ -53,25 +67,29 @@ public:
 signals:
   void visibleChanged();
   void tilesChanged();
+  void regionChanged(QRect cases);
 
 protected:
   void loadTiles(const QJsonArray&, const QVector<Tileset*>& tilesets);
   void prepareRenderRect();
   void prepareRenderSize();
-  QQmlListProperty<Tile> getQmlTiles();
-  static int             tilePropertyListCount(QQmlListProperty<Tile>*);
-  static Tile*           tilePropertyListAt(QQmlListProperty<Tile>*, int);
+  TileLayerModel* getTilesModel();
+  quint32         slotFor(const Tileset*);
+  void            setCell(TileCell&, const Tileset*, int tileId);
+  void            setCellAt(int x, int y, const Tileset*, int tileId);
 
-  QString        name, zoneName;
-  QSize          size;
-  QPoint         offset;
-  QColor         color = Qt::transparent;
-  QVector<Tile*> tiles;
-  bool           visible = true;
-  bool           prerendered = false;
-  bool           dirtyRenderRect = true, dirtyRenderSize = true;
-  QRect          renderRect;
-  QSize          renderSize;
+  QString                 name, zoneName;
+  QSize                   size;
+  QPoint                  offset;
+  QColor                  color = Qt::transparent;
+  QVector<TileCell>       tiles;
+  QVector<const Tileset*> tilesets;
+  TileLayerModel*         tilesModel = nullptr;
+  bool                    visible = true;
+  bool                    prerendered = false;
+  bool                    dirtyRenderRect = true, dirtyRenderSize = true;
+  QRect                   renderRect;
+  QSize                   renderSize;
 };
 
 #endif // TILELAYER_H
@@ -0,0 +1,195 @@
+#include "tilelayeritem.h"
+#include "tileset.h"
+#include <QQuickWindow>
+#include <QSGGeometryNode>
+#include <QSGTextureMaterial>
+#include <QSGImageNode>
+#include <QSGRendererInterface>
+
+class TileLayerNode : public QSGNode
+{
+public:
+  ~TileLayerNode() override { qDeleteAll(textures); }
+
+  QSGTexture* textureFor(QQuickWindow* window, const Tileset* tileset)
+  {
+    auto it = textures.find(tileset);
+
+    if (it == textures.end())
+      it = textures.insert(tileset, window->createTextureFromImage(tileset->getImage()));
+    return *it;
+  }
+
+  QSize                              chunkGrid;
+  QVector<QSGNode*>                  chunks;
+  QHash<const Tileset*, QSGTexture*> textures;
+};
+
+static void clearChunk(QSGNode* chunk)
+{
+  while (QSGNode* child = chunk->firstChild())
+  {
+    chunk->removeChildNode(child);
+    delete child;
+  }
+}
+
+static QSGGeometryNode* makeBatchNode(QSGTexture* texture, const QVector<Tile>& tiles)
+{
+  auto*       node     = new QSGGeometryNode;
+  auto*       geometry = new QSGGeometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), tiles.size() * 4, tiles.size() * 6, QSGGeometry::UnsignedShortType);
+  auto*       material = new QSGTextureMaterial;
+  auto*       vertices = geometry->vertexDataAsTexturedPoint2D();
+  quint16*    indexes  = geometry->indexDataAsUShort();
+  QRectF      subRect  = texture->normalizedTextureSubRect();
+  QSizeF      textureSize(texture->textureSize());
+
+  for (int i = 0 ; i < tiles.size() ; ++i)
+  {
+    QRect   clip = tiles[i].getRect();
+    QRectF  target(tiles[i].getRenderPosition(), clip.size());
+    QRectF  source(subRect.x() + clip.x() / textureSize.width()  * subRect.width(),
+                   subRect.y() + clip.y() / textureSize.height() * subRect.height(),
+                   clip.width()  / textureSize.width()  * subRect.width(),
+                   clip.height() / textureSize.height() * subRect.height());
+    quint16 first = static_cast<quint16>(i * 4);
+
+    vertices[first + 0].set(target.left(),  target.top(),    source.left(),  source.top());
+    vertices[first + 1].set(target.right(), target.top(),    source.right(), source.top());
+    vertices[first + 2].set(target.left(),  target.bottom(), source.left(),  source.bottom());
+    vertices[first + 3].set(target.right(), target.bottom(), source.right(), source.bottom());
+    indexes[i * 6 + 0] = first;
+    indexes[i * 6 + 1] = first + 1;
+    indexes[i * 6 + 2] = first + 2;
+    indexes[i * 6 + 3] = first + 1;
+    indexes[i * 6 + 4] = first + 3;
+    indexes[i * 6 + 5] = first + 2;
+  }
+  geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+  material->setTexture(texture);
+  material->setFiltering(QSGTexture::Nearest);
+  node->setGeometry(geometry);
+  node->setMaterial(material);
+  node->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial);
+  return node;
+}
+
+// The software backend can't draw custom geometry: it gets one image node per tile instead
+static void appendImageNodes(QSGNode* chunk, QQuickWindow* window, QSGTexture* texture, const QVector<Tile>& tiles)
+{
+  for (const Tile& tile : tiles)
+  {
+    QSGImageNode* node = window->createImageNode();
+    QRect         clip = tile.getRect();
+
+    node->setTexture(texture);
+    node->setSourceRect(clip);
+    node->setRect(QRectF(tile.getRenderPosition(), clip.size()));
+    node->setFiltering(QSGTexture::Nearest);
+    chunk->appendChildNode(node);
+  }
+}
+
+static void buildChunk(QSGNode* chunk, TileLayerNode& root, QQuickWindow* window, const TileLayer& layer, QRect cases)
+{
+  QVector<const Tileset*>              order;
+  QHash<const Tileset*, QVector<Tile>> batches;
+  QVector<Tile>                        tiles;
+  bool                                 software = window->rendererInterface()->graphicsApi() == QSGRendererInterface::Software;
+
+  clearChunk(chunk);
+  for (int y = cases.top() ; y <= cases.bottom() ; ++y)
+  {
+    for (int x = cases.left() ; x <= cases.right() ; ++x)
+    {
+      tiles.clear();
+      layer.appendTilesAt(x, y, tiles);
+      for (const Tile& tile : qAsConst(tiles))
+      {
+        if (!tile.getTileset())
+          continue ;
+        if (!batches.contains(tile.getTileset()))
+          order << tile.getTileset();
+        batches[tile.getTileset()] << tile;
+      }
+    }
+  }
+  for (const Tileset* tileset : qAsConst(order))
+  {
+    QSGTexture* texture = root.textureFor(window, tileset);
+
+    if (software)
+      appendImageNodes(chunk, window, texture, batches[tileset]);
+    else
+      chunk->appendChildNode(makeBatchNode(texture, batches[tileset]));
+  }
+}
+
+TileLayerItem::TileLayerItem(QQuickItem* parent) : QQuickItem(parent)
+{
+  setFlag(ItemHasContents, true);
+}
+
+void TileLayerItem::setTileLayer(TileLayer* value)
+{
+  if (tileLayer != value)
+  {
+    disconnect(layerObserver);
+    tileLayer = value;
+    if (tileLayer)
+    {
+      layerObserver = connect(tileLayer, &TileLayer::regionChanged, this, &TileLayerItem::onRegionChanged);
+      dirtyRegion = QRect(QPoint(0, 0), tileLayer->getSize());
+    }
+    emit tileLayerChanged();
+    update();
+  }
+}
+
+void TileLayerItem::onRegionChanged(QRect cases)
+{
+  dirtyRegion = dirtyRegion.united(cases);
+  update();
+}
+
+QSGNode* TileLayerItem::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData*)
+{
+  auto* root = static_cast<TileLayerNode*>(oldNode);
+
+  if (!tileLayer)
+  {
+    delete root;
+    return nullptr;
+  }
+
+  QSize size = tileLayer->getSize();
+  QSize chunkGrid((size.width() + chunkSize - 1) / chunkSize, (size.height() + chunkSize - 1) / chunkSize);
+
+  if (!root || root->chunkGrid != chunkGrid)
+  {
+    delete root;
+    root = new TileLayerNode;
+    root->chunkGrid = chunkGrid;
+    for (int i = 0 ; i < chunkGrid.width() * chunkGrid.height() ; ++i)
+    {
+      root->chunks << new QSGNode;
+      root->appendChildNode(root->chunks.last());
+    }
+    dirtyRegion = QRect(QPoint(0, 0), size);
+  }
+  dirtyRegion = dirtyRegion.intersected(QRect(QPoint(0, 0), size));
+  if (!dirtyRegion.isEmpty())
+  {
+    for (int chunkY = dirtyRegion.top() / chunkSize ; chunkY <= dirtyRegion.bottom() / chunkSize ; ++chunkY)
+    {
+      for (int chunkX = dirtyRegion.left() / chunkSize ; chunkX <= dirtyRegion.right() / chunkSize ; ++chunkX)
+      {
+        QRect cases(chunkX * chunkSize, chunkY * chunkSize, chunkSize, chunkSize);
+
+        buildChunk(root->chunks.at(chunkY * chunkGrid.width() + chunkX), *root, window(), *tileLayer, cases.intersected(QRect(QPoint(0, 0), size)));
+      }
+    }
+    dirtyRegion = QRect();
+  }
+  return root;
+}
@@ -0,0 +1,40 @@
+#ifndef  TILELAYERITEM_H
+# define TILELAYERITEM_H
+
+# include <QQuickItem>
+# include <QPointer>
+# include "tilelayer.h"
+
+// Draws a tile layer straight into the scene graph: the layer is split in chunks
+// of chunkSize x chunkSize cases, and each chunk batches its tiles in one geometry
+// node per tileset texture. Chunks are only rebuilt when the layer reports changes
+// in the cases they cover.
+class TileLayerItem : public QQuickItem
+{
+  Q_OBJECT
+
+  Q_PROPERTY(TileLayer* tileLayer READ getTileLayer WRITE setTileLayer NOTIFY tileLayerChanged)
+public:
+  static const int chunkSize = 16;
+
+  explicit TileLayerItem(QQuickItem* parent = nullptr);
+
+  TileLayer* getTileLayer() const { return tileLayer; }
+  void       setTileLayer(TileLayer*);
+
+signals:
+  void tileLayerChanged();
+
+protected:
+  QSGNode* updatePaintNode(QSGNode*, UpdatePaintNodeData*) override;
+
+private slots:
+  void onRegionChanged(QRect cases);
+
+private:
+  QPointer<TileLayer>     tileLayer;
+  QMetaObject::Connection layerObserver;
+  QRect                   dirtyRegion;
+};
+
+#endif // TILELAYERITEM_H
@@ -0,0 +1,57 @@
+#include "tilelayermodel.h"
+#include "tilelayer.h"
+
+TileLayerModel::TileLayerModel(TileLayer* layer) : QAbstractListModel(layer), layer(*layer)
+{
+  connect(layer, &TileLayer::tilesChanged, this, &TileLayerModel::refresh);
+  refresh();
+}
+
+void TileLayerModel::refresh()
+{
+  beginResetModel();
+  cells.clear();
+  for (int i = 0 ; i < layer.getCellCount() ; ++i)
+  {
+    if (!layer.isCellEmpty(i))
+      cells << i;
+  }
+  endResetModel();
+}
+
+int TileLayerModel::rowCount(const QModelIndex& parent) const
+{
+  return parent.isValid() ? 0 : cells.size();
+}
+
+QVariant TileLayerModel::data(const QModelIndex& index, int role) const
+{
+  if (index.isValid() && index.row() < cells.size())
+  {
+    int  cell = cells.at(index.row());
+    Tile tile = layer.getTile(cell % layer.getSize().width(), cell / layer.getSize().width());
+
+    switch (role)
+    {
+    case ImageRole:
+      return tile.getImage();
+    case ClippedRectRole:
+      return tile.getRect();
+    case PositionRole:
+      return tile.getPosition();
+    case RenderPositionRole:
+      return tile.getRenderPosition();
+    }
+  }
+  return QVariant();
+}
+
+QHash<int, QByteArray> TileLayerModel::roleNames() const
+{
+  return {
+    {ImageRole,          "image"},
+    {ClippedRectRole,    "clippedRect"},
+    {PositionRole,       "position"},
+    {RenderPositionRole, "renderPosition"}
+  };
+}
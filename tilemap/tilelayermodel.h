@@ -0,0 +1,37 @@
+#ifndef  TILELAYERMODEL_H
+# define TILELAYERMODEL_H
+
+# include <QAbstractListModel>
+# include <QVector>
+
+class TileLayer;
+
+// Lists the non-empty tiles of a layer for QML views. The rows only hold cell
+// indexes: tile data is built from the layer when a delegate asks for it.
+class TileLayerModel : public QAbstractListModel
+{
+  Q_OBJECT
+public:
+  enum TileRole
+  {
+    ImageRole = Qt::UserRole + 1,
+    ClippedRectRole,
+    PositionRole,
+    RenderPositionRole
+  };
+
+  explicit TileLayerModel(TileLayer* layer);
+
+  int                    rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant               data(const QModelIndex& index, int role) const override;
+  QHash<int, QByteArray> roleNames() const override;
+
+private slots:
+  void refresh();
+
+private:
+  TileLayer&   layer;
+  QVector<int> cells;
+};
+
+#endif // TILELAYERMODEL_H
@@ -3,6 +3,7 @@
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QFile>
+#include <QCryptographicHash>
 #include <QDebug>
 
 static const QString tilemapsPath = "./assets/tilemaps/";
@@ -38,22 +39,33 @@ void TileMap::removeTileZone(TileZone* zone)
   }
 }
 
-void TileMap::addLightLayer(TileLayer* zone)
+// The layer shared by the floor's light sources is only created once a light uses it
+LightLayer* TileMap::getDynamicLights()
 {
-  if (lights.indexOf(zone) < 0)
+  if (!dynamicLights)
   {
-    lights << zone;
+    Tileset* tileset = getTileset("lights");
+
+    if (!tileset)
+      return nullptr;
+    dynamicLights = new LightLayer(tileset, this);
+    dynamicLights->initialize(mapSize);
+    lights << dynamicLights;
     emit lightsChanged();
   }
+  return dynamicLights;
 }
 
-void TileMap::removeLightLayer(TileLayer* zone)
+// Covers the tilesets' definitions as well, since tile properties such as
+// walls and cover end up in the pathfinding data.
+QByteArray TileMap::hashSource(const QByteArray& source) const
 {
-  if (lights.indexOf(zone) >= 0)
-  {
-    lights.removeAll(zone);
-    emit lightsChanged();
-  }
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+
+  hash.addData(source);
+  for (const Tileset* tileset : tilesets)
+    hash.addData(tileset->getDefinitionHash());
+  return hash.result();
 }
 
 bool TileMap::load(const QString& name)
@@ -62,7 +74,8 @@ bool TileMap::load(const QString& name)
 
   if (sourceFile.open(QIODevice::ReadOnly))
   {
-    QJsonDocument document = QJsonDocument::fromJson(sourceFile.readAll());
+    QByteArray    source   = sourceFile.readAll();
+    QJsonDocument document = QJsonDocument::fromJson(source);
 
     tileSize.setWidth(document["tilewidth"].toInt(0));
     tileSize.setHeight(document["tileheight"].toInt(0));
@@ -70,6 +83,7 @@ bool TileMap::load(const QString& name)
     mapSize.setHeight(document["height"].toInt(0));
     loadTilesets(document["tilesets"].toArray());
     loadLayers(document["layers"].toArray());
+    sourceHash = hashSource(source);
     return true;
   }
   else
@@ -9,6 +9,7 @@
 # include "tilelayer.h"
 # include "tilezone.h"
 # include "floorlayer.h"
+# include "lightlayer.h"
 # include <QJsonObject>
 # include <QStringList>
 # include "globals.h"
@@ -35,6 +36,7 @@ public:
   void renderToImage(QImage& image, QPoint offset = {0,0});
 
   unsigned char getFloor() const { return floor; }
+  const QByteArray& getSourceHash() const { return sourceHash; }
   inline const QSize& getSize() const { return mapSize; }
   inline int getPixelWidth() const { return (mapSize.width() - 1) * tileSize.width();}
   inline const QSize& getTileSize() const { return tileSize; }
@@ -50,6 +52,7 @@ public:
   Q_INVOKABLE TileLayer* getLayer(const QString& name);
   Q_INVOKABLE TileLayer* getRoofLayer(const QString& name);
   Q_INVOKABLE TileLayer* getLightLayer(const QString& name);
+  LightLayer*            getDynamicLights();
   Q_INVOKABLE TileZone*  getZone(const QString& name);
   Q_INVOKABLE TileMap*   getFloor(const QString& name);
   Q_INVOKABLE TileMask*  getMaskLayerFor(TileLayer*) const;
@@ -61,8 +64,6 @@ public:
 public slots:
   void addTileZone(TileZone* zone);
   void removeTileZone(TileZone* zone);
-  void addLightLayer(TileLayer* zone);
-  void removeLightLayer(TileLayer* zone);
 
 signals:
   void onTextureListChanged();
@@ -79,6 +80,7 @@ private:
   void loadFloorFolder(const QJsonObject&);
   void loadPathfinding(const QJsonObject&);
   void loadLightTileset();
+  QByteArray hashSource(const QByteArray& source) const;
   int getLastGid() const;
 
   QSize               tileSize;
@@ -89,8 +91,10 @@ private:
   QList<TileZone*>    zones;
   QList<TileLayer*>   roofs;
   QList<TileLayer*>   lights;
+  LightLayer*         dynamicLights = nullptr;
   QList<TileZone*>    pathfindindingZones;
   QStringList         textureList;
+  QByteArray          sourceHash;
   unsigned char       floor = 0;
 };
 
@@ -4,6 +4,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QCryptographicHash>
 #include <QDebug>
 
 static const QString tilesetsPath = "./assets/tilesets/";
@@ -20,7 +21,10 @@ bool Tileset::load(const QString& filepath, int firstGid)
   this->firstGid = firstGid;
   if (sourceFile.open(QIODevice::ReadOnly))
   {
-    QJsonDocument document = QJsonDocument::fromJson(sourceFile.readAll());
+    QByteArray    definition = sourceFile.readAll();
+    QJsonDocument document = QJsonDocument::fromJson(definition);
+
+    definitionHash = QCryptographicHash::hash(definition, QCryptographicHash::Sha1);
 
     this->name = document["name"].toString();
     source = tilesetsPath + document["image"].toString();
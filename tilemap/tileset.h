@@ -22,6 +22,7 @@ public:
 
   inline const QString& getName() const { return name; }
   inline const QString& getSource() const { return source; }
+  const QByteArray& getDefinitionHash() const { return definitionHash; }
   QRect getClipRectFor(int tileId) const;
   QVariant getProperty(int tileId, const QByteArray& name) const;
   QSize getTileSize() const { return tileSize; }
@@ -45,6 +46,7 @@ private:
   int        tileCount;
   int        firstGid;
   TileProps  tileProperties;
+  QByteArray definitionHash;
 };
 
 #endif // TILESET_H
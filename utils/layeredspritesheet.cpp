@@ -1,7 +1,16 @@
 #include "layeredspritesheet.h"
 #include <QPainter>
+#include <algorithm>
 
-LayeredSpriteSheet::LayeredSpriteSheet(QSize size) : QImage(size, QImage::Format_ARGB32)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define LAYEREDSPRITESHEET_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# include <arm_neon.h>
+# define LAYEREDSPRITESHEET_NEON
+#endif
+
+LayeredSpriteSheet::LayeredSpriteSheet(QSize size) : QImage(size, QImage::Format_ARGB32_Premultiplied)
 {
   fill(Qt::transparent);
 }
@@ -15,27 +24,64 @@ void LayeredSpriteSheet::addLayer(const QImage& source)
   painter.end();
 }
 
+// Writes `tint` wherever the mask pixel is neither transparent nor black, and
+// transparency everywhere else.
+static void tintScanLine(const QRgb* mask, QRgb* output, int width, QRgb tint)
+{
+  int x = 0;
+
+#if defined(LAYEREDSPRITESHEET_SSE2)
+  const __m128i rgbBits   = _mm_set1_epi32(0x00FFFFFF);
+  const __m128i alphaBits = _mm_set1_epi32(static_cast<int>(0xFF000000));
+  const __m128i zero      = _mm_setzero_si128();
+  const __m128i tints     = _mm_set1_epi32(static_cast<int>(tint));
+
+  for (; x + 4 <= width ; x += 4)
+  {
+    __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + x));
+    __m128i skip   = _mm_or_si128(_mm_cmpeq_epi32(_mm_and_si128(pixels, rgbBits), zero),
+                                  _mm_cmpeq_epi32(_mm_and_si128(pixels, alphaBits), zero));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + x), _mm_andnot_si128(skip, tints));
+  }
+#elif defined(LAYEREDSPRITESHEET_NEON)
+  const uint32x4_t rgbBits   = vdupq_n_u32(0x00FFFFFF);
+  const uint32x4_t alphaBits = vdupq_n_u32(0xFF000000);
+  const uint32x4_t zero      = vdupq_n_u32(0);
+  const uint32x4_t tints     = vdupq_n_u32(tint);
+
+  for (; x + 4 <= width ; x += 4)
+  {
+    uint32x4_t pixels = vld1q_u32(reinterpret_cast<const uint32_t*>(mask + x));
+    uint32x4_t skip   = vorrq_u32(vceqq_u32(vandq_u32(pixels, rgbBits), zero),
+                                  vceqq_u32(vandq_u32(pixels, alphaBits), zero));
+
+    vst1q_u32(reinterpret_cast<uint32_t*>(output + x), vbicq_u32(tints, skip));
+  }
+#endif
+  for (; x < width ; ++x)
+    output[x] = (mask[x] & 0x00FFFFFF) && (mask[x] & 0xFF000000) ? tint : 0;
+}
+
 void LayeredSpriteSheet::addColorLayer(QColor color, const QImage &mask)
 {
   if (color != Qt::transparent)
   {
-    QImage   colorLayer(size(), QImage::Format_ARGB32);
-    QPainter painter;
+    const QImage source = mask.format() == QImage::Format_ARGB32 ? mask : mask.convertToFormat(QImage::Format_ARGB32);
+    const QRgb   tint = qPremultiply(color.rgba());
+    const int    width = std::min(source.width(), size().width());
+    const int    height = std::min(source.height(), size().height());
+    QImage       colorLayer(size(), QImage::Format_ARGB32_Premultiplied);
+    QPainter     painter;
 
-    colorLayer.fill(Qt::transparent);
-    painter.begin(&colorLayer);
-    for (int x = 0 ; x < size().width() ; ++x)
+    if (width < size().width() || height < size().height())
+      colorLayer.fill(Qt::transparent);
+    for (int y = 0 ; y < height ; ++y)
     {
-      for (int y = 0 ; y < size().height() ; ++y)
-      {
-         QColor baseColor   = mask.pixelColor(x, y);
-         bool   blackish    = baseColor.red() == 0 && baseColor.green() == 0 && baseColor.blue() == 0;
-
-         if (!blackish && baseColor.alpha() != QColor(Qt::transparent).alpha())
-           colorLayer.setPixelColor(x, y, color);
-      }
+      tintScanLine(reinterpret_cast<const QRgb*>(source.constScanLine(y)),
+                   reinterpret_cast<QRgb*>(colorLayer.scanLine(y)),
+                   width, tint);
     }
-    painter.end();
     painter.begin(this);
     painter.drawImage(0, 0, colorLayer);
     painter.end();